@@ -14,6 +14,34 @@
 #include <algorithm>
 #include <stdlib.h>
 #include <time.h>
+#include <sstream>
+#include <string>
+#include <queue>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <random>
+#include <set>
+#include <climits>
+#include <cmath>
+#include <bitset>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using namespace std;
 
@@ -84,10 +112,17 @@ public:
     void set_cap_left(int);    // Calculate the residual capacity of a bin and set it.
     const int get_cap_left();  // Get the residual capacity of the bin.
     void encase(Item);         // Put an item into a bin.
+    Item remove(int);          // Take an item out of a bin.
+    const int find(int);       // Get the position of an item of a size in the bin.
+    const int get_capacity();  // Get the capacity of the bin.
+    void set_type(int, int);   // Give the bin a bin type and its capacity.
+    const int get_type();      // Get the bin type of the bin.
     vector<Item> packed_items; // The packed items in the bin.
+    vector<pair<int, int>> size_counts; // The sizes of the packed items and how many of each, largest size first.
 private:
     int capacity;
     int cap_left;
+    int type;
 };
 
 /**
@@ -99,6 +134,41 @@ Bin::Bin(int capacity)
 {
     this->capacity = capacity;
     cap_left = capacity;
+    type = -1;
+}
+
+/**
+ * This function is used to get the capacity of the bin.
+ *
+ * @return              int type, the capacity of the bin.
+ */
+const int Bin::get_capacity()
+{
+    return capacity;
+}
+
+/**
+ * This function is used to give the bin one of the bin types of the instance. The residual capacity follows the new
+ * capacity and the packed items stay.
+ *
+ * @param type          int type, the position of the bin type.
+ * @param capacity      int type, the capacity of the bin type.
+ */
+void Bin::set_type(int type, int capacity)
+{
+    this->type = type;
+    cap_left += capacity - this->capacity;
+    this->capacity = capacity;
+}
+
+/**
+ * This function is used to get the bin type of the bin.
+ *
+ * @return              int type, the position of the bin type, -1 if the bins of the instance all have its capacity.
+ */
+const int Bin::get_type()
+{
+    return type;
 }
 
 /**
@@ -130,8 +200,87 @@ void Bin::encase(Item item)
 {
     packed_items.push_back(item);
     set_cap_left(get_cap_left() - item.get_size());
+    int i = 0;
+    while (i < size_counts.size() && size_counts[i].first > item.get_size())
+    {
+        i++;
+    }
+    if (i < size_counts.size() && size_counts[i].first == item.get_size())
+    {
+        size_counts[i].second++;
+    }
+    else
+    {
+        size_counts.insert(size_counts.begin() + i, make_pair(item.get_size(), 1));
+    }
+}
+
+/**
+ * This function is used to take an item out of a bin and give back its size to the residual capacity.
+ *
+ * @param position      int type, the position of the item in packed_items.
+ * @return              Item type, the item taken out.
+ */
+Item Bin::remove(int position)
+{
+    Item item = packed_items[position];
+    packed_items.erase(packed_items.begin() + position);
+    set_cap_left(get_cap_left() + item.get_size());
+    for (int i = 0; i < size_counts.size(); i++)
+    {
+        if (size_counts[i].first == item.get_size())
+        {
+            if (--size_counts[i].second == 0)
+            {
+                size_counts.erase(size_counts.begin() + i);
+            }
+            break;
+        }
+    }
+    return item;
+}
+
+/**
+ * This function is used to find an item of a size in the bin. All the items of the same size are the same to the
+ * neighborhoods, so the last one is taken as it is the cheapest to remove.
+ *
+ * @param size          int type, the size.
+ * @return              int type, the position of the item in packed_items, -1 if there is none.
+ */
+const int Bin::find(int size)
+{
+    for (int i = packed_items.size() - 1; i >= 0; i--)
+    {
+        if (packed_items[i].get_size() == size)
+        {
+            return i;
+        }
+    }
+    return -1;
 }
 
+/**
+ * This class is a group of items with the same size. As the items of a problem are sorted, the items of a size class are
+ * next to each other: they are the count items from the position first.
+ */
+struct SizeClass
+{
+    int size;
+    int first;
+    int count;
+};
+
+/**
+ * This class is a type of bin for the variable-sized bin packing: its capacity, its cost and how many bins of the type
+ * may be used, 0 for no limit.
+ */
+struct BinType
+{
+    int capacity;
+    int cost;
+    int limit;
+};
+
 /**
  * This class is used to store the information of the problem like the identifier, the capacity, the best solution, all the items,
  * read file function and other relevant functions.
@@ -139,28 +288,36 @@ void Bin::encase(Item item)
 class Problem
 {
 public:
-    Problem(ifstream &inFile);     // The constructor of class Problem.
+    Problem(istream &inFile);      // The constructor of class Problem.
+    Problem(string, int, const int *, int, int); // The constructor of class Problem from item sizes in memory.
+    Problem(string, int, int, const uint32_t *, const uint32_t *, int); // The constructor of class Problem from sorted items.
     const string get_identifier(); // Get the identifier of an instance
     const int get_capacity();      // Get the capacity of an instance.
+    void set_capacity(int);        // Set the capacity of an instance.
     const int get_num_items();     // Get the total number of items of an instance.
     const int get_best_solution(); // Get the best solution of the instance.
+    const int get_next_index();    // Get the index that the next added item will take.
     void deleteItem(Item);         // Delete an item from the instance.
+    vector<Item> update(vector<int>, vector<int>); // Add and remove items when the order changes.
+    vector<SizeClass> get_size_classes(); // Group the items by size.
+    vector<Bin> reduce();          // Fix the bins proved optimal by the Martello-Toth reductions.
     vector<Item> items;            // All the items of a instance.
 private:
     string identifier;
     int capacity;
     int num_items;
     int best_solution;
+    int next_index;
 };
 
 /**
  * This function is the Constructor of class Problem. This function gets the basic information of an instance like
  * identifier, capacity, the best solution and every item. And this function also sort all these items in a decreasing
- * sequence by using bubble sorting.
+ * sequence.
  *
- * @param inFile        ifstream reference type, the target file.
+ * @param inFile        istream reference type, the target file or any other stream in the same text format.
  */
-Problem::Problem(ifstream &inFile)
+Problem::Problem(istream &inFile)
 {
     string str;
     string substr;
@@ -174,26 +331,71 @@ Problem::Problem(ifstream &inFile)
     substr = to_string(num_items);
     str.erase(0, substr.length() + 1);
     best_solution = atoi(str.c_str()); // Get the best solution.
+    items.reserve(num_items);
     for (int i = 0; i < num_items; i++)
     { // Store the items.
         getline(inFile, str);
         items.push_back(atoi(str.c_str()));
         items[i].setIndex(i);
     }
+    next_index = num_items;
     /**
-     * Bubble sorting in decreasing sequence.
+     * Sorting in decreasing sequence. The sort is stable, so items of the same size keep the order of the file.
      */
-    for (int i = 0; i < items.size(); i++)
+    stable_sort(items.begin(), items.end(), [](Item a, Item b)
+                { return a.get_size() > b.get_size(); });
+}
+
+/**
+ * This function is the constructor of class Problem from item sizes that are already in memory. The items take the
+ * indexes of their positions and are sorted in a decreasing sequence.
+ *
+ * @param identifier    string type, the identifier of the instance.
+ * @param capacity      int type, the capacity of bins.
+ * @param sizes         const int pointer type, the sizes of the items.
+ * @param num_items     int type, the number of items.
+ * @param best_solution int type, the best known number of bins, used for the abs-gap only.
+ */
+Problem::Problem(string identifier, int capacity, const int *sizes, int num_items, int best_solution)
+{
+    this->identifier = identifier;
+    this->capacity = capacity;
+    this->num_items = num_items;
+    this->best_solution = best_solution;
+    this->next_index = num_items;
+    items.reserve(num_items);
+    for (int i = 0; i < num_items; i++)
     {
-        for (int j = 0; j < items.size() - 1; j++)
-        {
-            if (items[j].get_size() < items[j + 1].get_size())
-            {
-                Item item = items[j];
-                items[j] = items[j + 1];
-                items[j + 1] = item;
-            }
-        }
+        items.push_back(sizes[i]);
+        items[i].setIndex(i);
+    }
+    stable_sort(items.begin(), items.end(), [](Item a, Item b)
+                { return a.get_size() > b.get_size(); });
+}
+
+/**
+ * This function is the constructor of class Problem from items that are already sorted in a decreasing sequence, as they
+ * are stored in a binary instance file, so no sorting is done.
+ *
+ * @param identifier    string type, the identifier of the instance.
+ * @param capacity      int type, the capacity of bins.
+ * @param best_solution int type, the best known number of bins.
+ * @param sizes         const uint32_t pointer type, the sorted sizes.
+ * @param indexes       const uint32_t pointer type, the original index of every sorted item.
+ * @param num_items     int type, the number of items.
+ */
+Problem::Problem(string identifier, int capacity, int best_solution, const uint32_t *sizes, const uint32_t *indexes, int num_items)
+{
+    this->identifier = identifier;
+    this->capacity = capacity;
+    this->num_items = num_items;
+    this->best_solution = best_solution;
+    this->next_index = num_items;
+    items.reserve(num_items);
+    for (int i = 0; i < num_items; i++)
+    {
+        items.push_back(sizes[i]);
+        items[i].setIndex(indexes[i]);
     }
 }
 
@@ -217,6 +419,16 @@ const int Problem::get_capacity()
     return capacity;
 }
 
+/**
+ * This function is used to set the capacity of an instance, when the bin types replace the capacity of the data file.
+ *
+ * @param capacity      int type, the capacity.
+ */
+void Problem::set_capacity(int capacity)
+{
+    this->capacity = capacity;
+}
+
 /**
  * This function is used to get the quantity of the items
  *
@@ -238,768 +450,4578 @@ const int Problem::get_best_solution()
 }
 
 /**
- * This function is used to move the item out from the
+ * This function is used to get the index that the next added item will take. Removed indexes are never reused.
  *
- * @param item          Item item. the target item to move out.
+ * @return              int type, the index of the next added item.
  */
-void Problem::deleteItem(Item item)
+const int Problem::get_next_index()
 {
-    for (int i = 0; i < items.size(); i++)
+    return next_index;
+}
+
+/**
+ * This function is used to change the items of the instance when the order changes. The added items take new indexes
+ * after all the existing ones and the items stay sorted in a decreasing sequence. Unknown indexes to remove are ignored.
+ *
+ * @param added         vector<int> type, the sizes of the added items.
+ * @param removed       vector<int> type, the indexes of the removed items.
+ * @return              vector<Item> type, the added items with their indexes.
+ */
+vector<Item> Problem::update(vector<int> added, vector<int> removed)
+{
+    vector<bool> gone(next_index, false);
+    vector<Item> fresh;
+    for (int i = 0; i < removed.size(); i++)
     {
-        if (items[i].getIndex() == item.getIndex())
+        if (removed[i] >= 0 && removed[i] < next_index)
         {
-            items.erase(items.begin() + i);
-            return;
+            gone[removed[i]] = true;
         }
     }
+    items.erase(remove_if(items.begin(), items.end(), [&gone](Item item)
+                          { return gone[item.getIndex()]; }),
+                items.end());
+    for (int i = 0; i < added.size(); i++)
+    {
+        Item item(added[i]);
+        item.setIndex(next_index++);
+        fresh.push_back(item);
+    }
+    stable_sort(fresh.begin(), fresh.end(), [](Item a, Item b)
+                { return a.get_size() > b.get_size(); });
+    int middle = items.size();
+    items.insert(items.end(), fresh.begin(), fresh.end());
+    inplace_merge(items.begin(), items.begin() + middle, items.end(), [](Item a, Item b)
+                  { return a.get_size() > b.get_size(); });
+    num_items = items.size();
+    return fresh;
 }
 
 /**
- * This class is used to store the information of the solution like the packed bins, the number of bins, the abs-gap and
- * all the disposal of the bins and items including: relaxed minimum bin slack to get the initial solution. And the variable
- * neighborhood search(VNS) to improve the solution to reduce bins. The VNS can be divided into two parts:Variable neighborhood
- * descent(VND) and Shaking procedure. And a fitness function to evaluate the better solution.
- *
- * VND(4 actions):
- * 1. shift: This action selects a item from the bin that has the largest residual capacity and tries to move the smallest item
- * to the rest of bins by using best fit descent.
- * 2. exchange_largest: This action picks the largest item from the item which has the maximal residual capacity and tries to
- * change it with another smaller item from other bins by using best fit descent.
- * 3: exchange_smallest: This action picks the smallest item from the item which has the maximal residual capacity and tries to
- * change it with another smaller item from other bins by using best fit descents.
- * 4: split: This action randomly select half items from a bin that exceeds the average items per bin to a new bin.
+ * This function is used to group the sorted items by size, in a decreasing sequence of sizes.
  *
- * Shaking procedure: The shaking procedure is to randomly select two items from two different bins and swap the two items.
- *
- * Fitness function:
- * 1. If the new solution has fewer bins, then the new solution is better.
- * 2. If the new solution has the same bins with the old one, then compare the two bins that have been disposed.
- * If the absolute value of the difference between the residual capacity of the two after-disposed bins is larger than the
- * absolute value of the difference between the residual capacity of the two before-disposed bins, then the new solution is better.
- * 3. If the new solution has more bins, then compare the items in the new bin and the bin with the maximal residual capacity.
- * If there is one item in the new bin has fewer size than any item in the bin with the maximal residual capacity, then the new
- * solution is better.
+ * @return              vector<SizeClass> type, the size classes.
  */
-class Solution
+vector<SizeClass> Problem::get_size_classes()
 {
-public:
-    Solution(Problem);                                 // The constructor the class Solution.
-    void set_objective(int);                           // Set the objective for each problem instance.
-    const string get_identifier();                     // Get the identifier for the problem instance.
-    const float get_objective();                       // Get the objective for each problem instance.
-    const int get_capacity();                          // Get the capacity for each problem instance.
-    const float get_abs_gap();                         // Get the abs_gap for each problem instance.
-    void set_bins(vector<Bin>);                        // Set the bins for the problem instance.
-    void minimumBinSlack(int, int, int, Bin, Problem); // Relaxed mbs for a single bin.
-    void initialize(int, Problem);                     // The process of get initial solution.
-    vector<Bin> get_bins();                            // Get the current bins of the instance.
-    vector<Bin> shift(vector<Bin>);                    // Heuristic 1.
-    vector<Bin> exchange_largest(vector<Bin>);         // heuristic 2.
-    vector<Bin> exchange_smallest(vector<Bin>);        // Heuristic 3.
-    vector<Bin> split(vector<Bin>);                    // Heuristic 4.
-    vector<Bin> shaking(vector<Bin>);                  // Shaking procedure by swapping two items randomly.
-    vector<Bin> VNS(int);                              // Variable neighbor search.
-    bool evaluation(vector<Bin>, vector<Bin>);         // Fitness function to evaluate the current solution.
-
-private:
-    string identifier;
-    int capacity;
-    float objective;
-    float abs_gap;
-    int best_known;
-    vector<Bin> bins;
-};
+    vector<SizeClass> classes;
+    for (int i = 0; i < items.size(); i++)
+    {
+        if (classes.empty() || classes.back().size != items[i].get_size())
+        {
+            SizeClass size_class = {items[i].get_size(), i, 0};
+            classes.push_back(size_class);
+        }
+        classes.back().count++;
+    }
+    return classes;
+}
 
 /**
- * This function is constructor of class Solution. This constructor initializes the identifier, capacity, best known solution
- * and prepare enough bins to pack all items.
+ * This function is used to apply the Martello-Toth reduction procedure before the search. From the largest item j that
+ * is still free, let k be the largest other free item that fits with j:
+ * 1. If no item fits with j, a bin with j alone is in some optimal solution.
+ * 2. If j and k fill the capacity exactly, or no two other items fit with j together, the bin {j, k} dominates every
+ * other bin containing j, so it is in some optimal solution.
+ * Otherwise j is left to the search but can still be the k of a smaller item. The fixed bins are taken out of the
+ * problem, which keeps the number of items of the instance so that the settings keyed on it do not change. The free
+ * items are kept in a multiset, so the procedure takes O(n log n).
  *
- * @param problem       Problem type, a whole instance.
+ * @return              vector<Bin> type, the fixed bins.
  */
-Solution::Solution(Problem problem)
+vector<Bin> Problem::reduce()
 {
-    this->identifier = problem.get_identifier();
-    this->capacity = problem.get_capacity();
-    this->best_known = problem.get_best_solution();
-    for (int i = 0; i < problem.items.size(); i++)
+    vector<Bin> fixed;
+    vector<bool> taken(items.size(), false);
+    multiset<pair<int, int>> free; // Size and position of the free items.
+    for (int i = 0; i < items.size(); i++)
+    {
+        free.insert(make_pair(items[i].get_size(), i));
+    }
+    for (int j = 0; j < items.size(); j++)
     {
+        if (taken[j])
+        {
+            continue;
+        }
+        free.erase(make_pair(items[j].get_size(), j));
+        multiset<pair<int, int>>::iterator partner = free.upper_bound(make_pair(capacity - items[j].get_size(), INT_MAX));
         Bin bin(capacity);
-        bins.push_back(bin);
+        bin.encase(items[j]);
+        if (partner == free.begin())
+        { // Nothing fits with the item.
+            taken[j] = true;
+            fixed.push_back(bin);
+            continue;
+        }
+        partner--;
+        bool exact = items[j].get_size() + partner->first == capacity;
+        bool single = free.size() < 2 || items[j].get_size() + free.begin()->first + next(free.begin())->first > capacity;
+        if (exact || single)
+        { // The pair is dominant.
+            int k = partner->second;
+            free.erase(partner);
+            bin.encase(items[k]);
+            taken[j] = true;
+            taken[k] = true;
+            fixed.push_back(bin);
+        }
+        else
+        {
+            free.insert(make_pair(items[j].get_size(), j));
+        }
+    }
+    int kept = 0;
+    for (int i = 0; i < items.size(); i++)
+    {
+        if (!taken[i])
+        {
+            items[kept++] = items[i];
+        }
     }
+    items.resize(kept, Item(0));
+    return fixed;
 }
 
 /**
- * This function is used to pack items for every single bin by using relaxed minimum bin slack.
+ * This function is used to move the item out from the
  *
- * @param crack         int type, the permitted crack of a bin.
- * @param initial       int type, the beginning index of an item.
- * @param chosen        int type, the chosen index of a bin.
- * @param bin           Bin type, a bin to pack items.
- * @param problem       Problem problem, problem instance.
+ * @param item          Item item. the target item to move out.
  */
-void Solution::minimumBinSlack(int crack, int initial, int chosen, Bin bin, Problem problem)
+void Problem::deleteItem(Item item)
 {
-    for (int i = initial; i < problem.items.size(); i++)
+    for (int i = 0; i < items.size(); i++)
     {
-        if (problem.items[i].get_size() <= bin.get_cap_left())
+        if (items[i].getIndex() == item.getIndex())
         {
-            bin.encase(problem.items[i]);
-            minimumBinSlack(crack, i + 1, chosen, bin, problem);                       // Recursive to the next.
-            bin.set_cap_left(bin.get_cap_left() + bin.packed_items.back().get_size()); // Move out the last fo find a more suitable item.
-            bin.packed_items.pop_back();
-            if (bins[chosen].get_cap_left() <= crack)
-            {
-                return;
-            }
+            items.erase(items.begin() + i);
+            return;
         }
     }
-    if (bin.get_cap_left() < bins[chosen].get_cap_left())
-    { // If the bin has fewer residual capacity, then select it.
-        bins[chosen] = bin;
-    }
 }
 
 /**
- * This function is used to initialize the solution by using relaxed minimum bin slack until every items are packed.
+ * This class is used to read a binary instance file by mapping it into memory, so that any instance can be loaded by its
+ * position without reading or parsing the others. Only the pages of the instance loaded are read from the disk.
  *
- * @param crack         int type, the permitted crack.
- * @param problem       Problem type , the instance.
+ * Layout (native byte order, every field 4 bytes unless said otherwise):
+ * 1. Header: the magic "BPPBIN1" with a terminating zero (8 bytes), the number of instances and a reserved zero.
+ * 2. Index: the offset from the start of the file of every instance (8 bytes each).
+ * 3. Every instance: capacity, number of items, best known solution, length of the identifier, the identifier padded to a
+ * multiple of 4 bytes, the sizes sorted in a decreasing sequence and then the original index of every sorted item.
  */
-void Solution::initialize(int crack, Problem problem)
+class InstanceFile
 {
-    int chosenBinIndex = 0;
-    while (problem.items.size() != 0)
+public:
+    InstanceFile(string);                  // Constructor of InstanceFile, map the file.
+    ~InstanceFile();                       // Destructor of InstanceFile, unmap the file.
+    const bool is_open();                  // Whether the file is mapped and is a binary instance file.
+    const int get_num_instances();         // Get the number of instances.
+    const bool check_problem(int);         // Whether the items of an instance can be loaded.
+    Problem get_problem(int);              // Load an instance by its position.
+    static bool is_binary(string);         // Whether a file is a binary instance file.
+    static bool convert(istream &, string); // Convert a data file in the text format into a binary instance file.
+private:
+    InstanceFile(const InstanceFile &);    // The mapping is not copied.
+    const char *data;
+    size_t length;
+    int num_instances;
+};
+
+/**
+ * The magic at the start of a binary instance file.
+ */
+const char BINARY_MAGIC[8] = "BPPBIN1";
+
+/**
+ * This function is the constructor of InstanceFile. It maps the whole file read-only and checks the header, the index and
+ * the head of every instance: every instance must start inside the file on a 4-byte boundary, and its identifier, sizes
+ * and indexes must end inside the file. Only the head of an instance is read, so its items are not paged in. A file that
+ * fails a check is not opened.
+ *
+ * @param path          string type, the path of the file.
+ */
+InstanceFile::InstanceFile(string path)
+{
+    data = nullptr;
+    length = 0;
+    num_instances = 0;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
     {
-        bins[chosenBinIndex].encase(problem.items[0]); // Pack one first.
-        Bin bridgeBin = bins[chosenBinIndex];
-        problem.deleteItem(problem.items[0]);
-        /**
-         * Remove all the empty bins.
-         */
-        if (problem.items.empty())
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size >= 16)
+    {
+        void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
         {
-            bool empty = true;
-            do
-            {
-                int num = bins.size();
-                int index = -1;
-                for (int i = 0; i < num; i++)
-                {
-                    if (bins[i].packed_items.empty())
-                    {
-                        index = i;
-                        break;
-                    }
-                }
-                if (index != -1)
-                {
-                    empty = false;
-                    bins.erase(bins.begin() + index);
-                }
-                else
-                {
-                    empty = true;
-                }
-            } while (!empty);
-            set_objective(bins.size());
-            return;
+            data = (const char *)mapped;
+            length = info.st_size;
         }
-        minimumBinSlack(crack, 0, chosenBinIndex, bridgeBin, problem); // For every bin.
-        for (int i = 0; i < bins[chosenBinIndex].packed_items.size(); i++)
+    }
+    close(fd); // The mapping stays valid.
+    if (data == nullptr)
+    {
+        return;
+    }
+    uint32_t count;
+    memcpy(&count, data + 8, 4);
+    bool valid = memcmp(data, BINARY_MAGIC, 8) == 0 && count <= INT_MAX && 16 + (uint64_t)count * 8 <= length;
+    for (uint32_t i = 0; valid && i < count; i++)
+    {
+        uint64_t offset;
+        uint32_t head[4];
+        memcpy(&offset, data + 16 + (size_t)i * 8, 8);
+        valid = offset % 4 == 0 && offset >= 16 + (uint64_t)count * 8 && offset <= length && length - offset >= 16;
+        if (valid)
         {
-            problem.deleteItem(bins[chosenBinIndex].packed_items[i]); // Remove the packed items.
+            memcpy(head, data + offset, 16);
+            uint64_t padded = ((uint64_t)head[3] + 3) / 4 * 4;
+            valid = head[0] <= INT_MAX && head[1] <= INT_MAX && head[2] <= INT_MAX && padded + (uint64_t)head[1] * 8 <= length - offset - 16;
         }
-        chosenBinIndex++;
     }
-    /**
-     * Remove all the empty bins.
-     */
-    bool empty = true;
-    do
+    if (!valid)
     {
-        int num = bins.size();
-        int index = -1;
-        for (int i = 0; i < num; i++)
-        {
-            if (bins[i].packed_items.empty())
-            {
-                index = i;
-                break;
-            }
-        }
-        if (index != -1)
-        {
-            empty = false;
-            bins.erase(bins.begin() + index);
-        }
-        else
+        munmap((void *)data, length);
+        data = nullptr;
+        return;
+    }
+    num_instances = count;
+}
+
+/**
+ * This function is the destructor of InstanceFile and unmaps the file.
+ */
+InstanceFile::~InstanceFile()
+{
+    if (data != nullptr)
+    {
+        munmap((void *)data, length);
+    }
+}
+
+/**
+ * This function is used to know whether the file is mapped and is a binary instance file.
+ *
+ * @return              bool type, true if the instances can be loaded.
+ */
+const bool InstanceFile::is_open()
+{
+    return data != nullptr;
+}
+
+/**
+ * This function is used to get the number of instances in the file.
+ *
+ * @return              int type, the number of instances.
+ */
+const int InstanceFile::get_num_instances()
+{
+    return num_instances;
+}
+
+/**
+ * This function is used to check the items of an instance before it is loaded: the sizes must be sorted in a decreasing
+ * sequence and the indexes must be 0 to the number of items - 1, each once, as convert writes them. The pages of the
+ * instance are read, as loading it does.
+ *
+ * @param position      int type, the position of the instance in the file, from 0.
+ * @return              bool type, true if the instance can be loaded.
+ */
+const bool InstanceFile::check_problem(int position)
+{
+    if (data == nullptr || position < 0 || position >= num_instances)
+    {
+        return false;
+    }
+    uint64_t offset;
+    uint32_t head[4];
+    memcpy(&offset, data + 16 + (size_t)position * 8, 8);
+    memcpy(head, data + offset, 16);
+    const uint32_t *sizes = (const uint32_t *)(data + offset + 16 + (head[3] + 3ULL) / 4 * 4);
+    const uint32_t *indexes = sizes + head[1];
+    vector<bool> seen(head[1], false);
+    for (uint32_t i = 0; i < head[1]; i++)
+    {
+        if (sizes[i] > INT_MAX || (i > 0 && sizes[i] > sizes[i - 1]) || indexes[i] >= head[1] || seen[indexes[i]])
         {
-            empty = true;
+            return false;
         }
-    } while (!empty);
-    set_objective(bins.size());
+        seen[indexes[i]] = true;
+    }
+    return true;
 }
 
 /**
- * This function is the variable neighborhood search including 4 neighborhoods to solve bin packing.
- * VND(4 actions):
- * 1. shift: This action selects a item from the bin that has the largest residual capacity and tries to move the smallest item
- * to the rest of bins by using best fit descent.
- * 2. exchange_largest: This action picks the largest item from the item which has the maximal residual capacity and tries to
- * change it with another smaller item from other bins by using best fit descent.
- * 3: exchange_smallest: This action picks the smallest item from the item which has the maximal residual capacity and tries to
- * change it with another smaller item from other bins by using best fit descents.
- * 4: split: This action is to randomly select half items from a bin that exceeds the average items per bin
- * to a new bin.
+ * This function is used to load an instance by its position. The sizes are copied from the mapping into the items of the
+ * instance as they are, already sorted, so nothing is parsed or sorted. The bounds of the instance are checked when the
+ * file is opened, and its items by check_problem.
  *
- * Shaking procedure: The shaking procedure picks randomly two items from different bins and swap them.
+ * @param position      int type, the position of the instance in the file, from 0.
+ * @return              Problem type, the instance.
+ */
+Problem InstanceFile::get_problem(int position)
+{
+    uint64_t offset;
+    uint32_t head[4];
+    memcpy(&offset, data + 16 + (size_t)position * 8, 8);
+    memcpy(head, data + offset, 16);
+    const char *identifier = data + offset + 16;
+    size_t padded = (head[3] + 3) / 4 * 4;
+    const uint32_t *sizes = (const uint32_t *)(identifier + padded);
+    const uint32_t *indexes = sizes + head[1];
+    return Problem(string(identifier, head[3]), head[0], head[2], sizes, indexes, head[1]);
+}
+
+/**
+ * This function is used to know whether a file starts with the magic of a binary instance file.
  *
- * Fitness function:
- * 1. If the new solution has fewer bins, then the new solution is better.
- * 2. If the new solution has the same bins with the old one, then compare the two bins that have been disposed.
- * If the absolute value of the difference between the residual capacity of the two after-disposed bins is larger than the
- * absolute value of the difference between the residual capacity of the two before-disposed bins, then the new solution is better.
- * 3. If the new solution has more bins, then compare the items in the new bin and the bin with the maximal residual capacity.
- * If there is one item in the new bin has fewer size than any item in the bin with the maximal residual capacity, then the new
- * solution is better.
+ * @param path          string type, the path of the file.
+ * @return              bool type, true if it is a binary instance file.
+ */
+bool InstanceFile::is_binary(string path)
+{
+    char magic[8] = "";
+    ifstream inFile(path.c_str(), ios::in | ios::binary);
+    inFile.read(magic, 8);
+    return inFile && memcmp(magic, BINARY_MAGIC, 8) == 0;
+}
+
+/**
+ * This function is used to convert a data file in the text format into a binary instance file. The items are sorted as
+ * Problem sorts them, so that loading needs no sorting.
  *
- * @param max_time      int type, the maximum time of running a single instance.
- * @return              vector<Bin> type, the current bins of the solution.
+ * @param inFile        istream reference type, the data file.
+ * @param path          string type, the path of the binary instance file to write.
+ * @return              bool type, false if the file can not be written.
  */
-vector<Bin> Solution::VNS(int max_time)
+bool InstanceFile::convert(istream &inFile, string path)
 {
-    vector<Bin> answer = get_bins();
-    vector<Bin> answer_new;
-    vector<Bin> answer_best = answer;
-    clock_t startTime, endTime;
-    int neighborhood = 2;
-    int num;
-    /**
-     * 4 neighborhoods. If find a better one then back to the first neighborhood, otherwise search in the next neighborhood.
-     */
-    startTime = clock();
-    while (true)
+    ofstream outFile(path.c_str(), ios::out | ios::binary);
+    if (!outFile)
     {
-        num = 1;
-        while (num <= neighborhood)
+        return false;
+    }
+    string str;
+    getline(inFile, str);
+    uint32_t count = atoi(str.c_str());
+    uint32_t reserved = 0;
+    vector<uint64_t> offsets(count);
+    outFile.write(BINARY_MAGIC, 8);
+    outFile.write((const char *)&count, 4);
+    outFile.write((const char *)&reserved, 4);
+    outFile.write((const char *)offsets.data(), count * 8); // Written again once the offsets are known.
+    for (int i = 0; i < count; i++)
+    {
+        Problem problem(inFile);
+        string identifier = problem.get_identifier();
+        uint32_t head[4] = {(uint32_t)problem.get_capacity(), (uint32_t)problem.items.size(), (uint32_t)problem.get_best_solution(), (uint32_t)identifier.length()};
+        vector<uint32_t> sizes(problem.items.size());
+        vector<uint32_t> indexes(problem.items.size());
+        for (int k = 0; k < problem.items.size(); k++)
         {
-            endTime = clock();
-            if (((double)(endTime - startTime) / CLOCKS_PER_SEC) >= max_time)
-            { // Limit of time.
-                return answer_best;
+            sizes[k] = problem.items[k].get_size();
+            indexes[k] = problem.items[k].getIndex();
+        }
+        offsets[i] = outFile.tellp();
+        outFile.write((const char *)head, 16);
+        outFile.write(identifier.c_str(), identifier.length());
+        outFile.write("\0\0\0", (4 - identifier.length() % 4) % 4);
+        outFile.write((const char *)sizes.data(), sizes.size() * 4);
+        outFile.write((const char *)indexes.data(), indexes.size() * 4);
+    }
+    outFile.seekp(16);
+    outFile.write((const char *)offsets.data(), count * 8);
+    return (bool)outFile;
+}
+
+/**
+ * This function is used to pack the items of a large instance by best fit decreasing for any capacity. The items are
+ * taken by size class: the best fitting bin of an item stays the best fitting bin of the next item of the same size until
+ * it can not take one more, so the bin is filled with as many items of the class as fit at once. The open bins are kept
+ * in a set ordered by residual capacity, so the packing takes O(n log n).
+ *
+ * @param problem       Problem reference type, the instance with the items sorted in a decreasing sequence.
+ * @param bin_of        vector<int> reference type, set to the bin of the item at every position of problem.items.
+ * @return              int type, the number of bins.
+ */
+int best_fit_generic(Problem &problem, vector<int> &bin_of)
+{
+    vector<SizeClass> classes = problem.get_size_classes();
+    set<pair<int, int>> open; // Residual capacity and index of the bins that can still take the smallest item.
+    vector<int> cap_left;
+    bin_of.assign(problem.items.size(), -1);
+    if (classes.empty())
+    {
+        return 0;
+    }
+    int smallest = classes.back().size;
+    for (int c = 0; c < classes.size(); c++)
+    {
+        int next = classes[c].first;
+        int end = classes[c].first + classes[c].count;
+        while (next < end)
+        {
+            int chosen;
+            set<pair<int, int>>::iterator best = open.lower_bound(make_pair(classes[c].size, -1));
+            if (best == open.end())
+            { // Open a new bin.
+                cap_left.push_back(problem.get_capacity());
+                chosen = cap_left.size() - 1;
             }
-            if (num == 1)
+            else
             {
-                answer_new = shift(answer); // Heuristic 1.
+                chosen = best->second;
+                open.erase(best);
             }
-            else if (num == 2)
-            {
-                answer_new = exchange_largest(answer); // Heuristic 2.
+            int fit = min(end - next, cap_left[chosen] / classes[c].size);
+            if (fit == 0)
+            { // An item larger than the capacity gets a bin of its own.
+                fit = 1;
             }
-            else if (num == 3)
+            for (int i = 0; i < fit; i++)
             {
-                answer_new = exchange_smallest(answer); // Heuristic 3.
+                bin_of[next++] = chosen;
+                cap_left[chosen] -= classes[c].size;
             }
-            else
+            if (cap_left[chosen] >= smallest)
             {
-                answer_new = split(answer); // Heuristic 4.
+                open.insert(make_pair(cap_left[chosen], chosen));
             }
+        }
+    }
+    return cap_left.size();
+}
 
-            if (evaluation(answer_new, answer))
-            { // If better, then return to Heuristic1.
-                answer = answer_new;
-                num = 1;
-                continue;
-            }
-            else
+/**
+ * This class is best fit decreasing specialized for a capacity known at compile time, for the standard capacities of
+ * the instances. The sizes are copied into the narrowest integer type that holds the capacity, so more of them share a
+ * cache line. The open bins are kept in one list per residual capacity and an array of words of fixed width marks the
+ * non-empty lists, so the best fitting bin is the first marked residual from the size of the item, found by a word scan
+ * without any tree. Items of the same size are put into the chosen bin by subtraction while they fit, without division.
+ */
+template <int CAPACITY, typename Size>
+class FixedCapacityKernel
+{
+public:
+    static int best_fit(Problem &, vector<int> &); // Pack the items and get the bin of every item.
+
+private:
+    static const int WORDS = CAPACITY / 64 + 1;            // The words of the marks of the residual capacities.
+    static int first_open(const uint64_t *, int);          // Get the first marked residual from a residual.
+};
+
+/**
+ * This function is used to get the first marked residual capacity from a residual capacity, by a scan of the words of
+ * the marks. The lowest set bit of a word is found by a de Bruijn multiplication, which needs no compiler builtin.
+ *
+ * @param open          const uint64_t pointer type, the WORDS words of the marks of the residual capacities.
+ * @param from          int type, the smallest residual capacity to look at.
+ * @return              int type, the first marked residual capacity, CAPACITY + 1 if there is none.
+ */
+template <int CAPACITY, typename Size>
+int FixedCapacityKernel<CAPACITY, Size>::first_open(const uint64_t *open, int from)
+{
+    static const int LOWEST[64] = {0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+                                   62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+                                   63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+                                   46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6};
+    int w = from / 64;
+    if (w >= WORDS)
+    {
+        return CAPACITY + 1;
+    }
+    uint64_t word = open[w] & (~0ULL << (from % 64));
+    while (word == 0)
+    {
+        if (++w >= WORDS)
+        {
+            return CAPACITY + 1;
+        }
+        word = open[w];
+    }
+    return w * 64 + LOWEST[((word & (0 - word)) * 0x03f79d71b4cb0a89ULL) >> 58];
+}
+
+/**
+ * This function is used to pack the items by best fit decreasing for the capacity CAPACITY.
+ *
+ * @param problem       Problem reference type, the instance with the items sorted in a decreasing sequence.
+ * @param bin_of        vector<int> reference type, set to the bin of the item at every position of problem.items.
+ * @return              int type, the number of bins.
+ */
+template <int CAPACITY, typename Size>
+int FixedCapacityKernel<CAPACITY, Size>::best_fit(Problem &problem, vector<int> &bin_of)
+{
+    int num_items = problem.items.size();
+    vector<Size> sizes(num_items);
+    for (int i = 0; i < num_items; i++)
+    {
+        sizes[i] = problem.items[i].get_size();
+    }
+    bin_of.assign(num_items, -1);
+    if (num_items == 0)
+    {
+        return 0;
+    }
+    vector<int> head(CAPACITY + 1, -1); // The first open bin of every residual capacity.
+    vector<int> next_bin;                // The next open bin of the same residual capacity.
+    vector<Size> cap_left;
+    uint64_t open[WORDS] = {}; // The residual capacities with an open bin.
+    Size smallest = sizes[num_items - 1];
+    int i = 0;
+    while (i < num_items)
+    {
+        Size size = sizes[i];
+        int residual = first_open(open, size);
+        int chosen;
+        if (residual > CAPACITY)
+        { // Open a new bin.
+            cap_left.push_back(CAPACITY);
+            next_bin.push_back(-1);
+            chosen = cap_left.size() - 1;
+        }
+        else
+        {
+            chosen = head[residual];
+            head[residual] = next_bin[chosen];
+            if (head[residual] == -1)
             {
-                num++;
+                open[residual / 64] &= ~(1ULL << (residual % 64));
             }
         }
-        if (evaluation(answer, answer_best))
-        { // If the new is better, then set it as best.
-            answer_best = answer;
+        do
+        { // Items of the same size while they fit.
+            bin_of[i++] = chosen;
+            cap_left[chosen] -= size;
+        } while (i < num_items && sizes[i] == size && cap_left[chosen] >= size);
+        if (cap_left[chosen] >= smallest && cap_left[chosen] > 0)
+        {
+            next_bin[chosen] = head[cap_left[chosen]];
+            head[cap_left[chosen]] = chosen;
+            open[cap_left[chosen] / 64] |= 1ULL << (cap_left[chosen] % 64);
         }
-        answer = shaking(answer); // Shaking procedure
     }
+    return cap_left.size();
 }
 
 /**
- * This function is the fitness function to evaluate the solution.
- * 1. If the new solution has fewer bins, then the new solution is better.
- * 2. If the new solution has the same bins with the old one, then compare the two bins that have been disposed.
- * If the absolute value of the difference between the residual capacity of the two after-disposed bins is larger than the
- * absolute value of the difference between the residual capacity of the two before-disposed bins, then the new solution is better.
- * 3. If the new solution has more bins, then compare the items in the new bin and the bin with the maximal residual capacity.
- * If there is one item in the new bin has fewer size than any item in the bin with the maximal residual capacity, then the new
- * solution is better.
+ * This function is used to pack the items by best fit decreasing with the kernel specialized for the capacity of the
+ * instance, or with the generic one if there is none for this capacity or an item is larger than the capacity, as the
+ * sizes of a kernel only hold up to its capacity.
  *
- * @param after         vector<Bin> type, the used bins of the new solution.
- * @param before        vector<Bin> type, the used bins of the old solution.
- * @return              bool type, new one better returns true or old one better returns false.
+ * @param problem       Problem reference type, the instance with the items sorted in a decreasing sequence.
+ * @param bin_of        vector<int> reference type, set to the bin of the item at every position of problem.items.
+ * @return              int type, the number of bins.
  */
-bool Solution::evaluation(vector<Bin> after, vector<Bin> before)
+int best_fit(Problem &problem, vector<int> &bin_of)
 {
-    if (after.size() < before.size())
-    { // If new solution has fewer bins.
-        return true;
+    if (!problem.items.empty() && (problem.items[0].get_size() > problem.get_capacity() || problem.items.back().get_size() < 0))
+    {
+        return best_fit_generic(problem, bin_of);
     }
-    else if (after.size() == before.size())
-    { // If has the same number of bins.
-        int diffA;
-        int diffB;
-        int k;
-        bool first = true;
-        vector<Bin> a = after;
-        vector<Bin> b = before;
-        for (int i = 0; i < before.size(); i++)
-        { // Find the two bins that swapped items.
-            if ((i == before.size() - 1) && (first))
+    switch (problem.get_capacity())
+    {
+    case 150:
+        return FixedCapacityKernel<150, uint8_t>::best_fit(problem, bin_of);
+    case 1000:
+        return FixedCapacityKernel<1000, uint16_t>::best_fit(problem, bin_of);
+    case 10000:
+        return FixedCapacityKernel<10000, uint16_t>::best_fit(problem, bin_of);
+    default:
+        return best_fit_generic(problem, bin_of);
+    }
+}
+
+/**
+ * This function is used to get the size of every item of an instance by its index, the reference to check a packing.
+ *
+ * @param problem       Problem reference type, the instance.
+ * @return              vector<int> type, the size of every index, -1 for an index that is not in the instance.
+ */
+vector<int> item_sizes(Problem &problem)
+{
+    vector<int> size_of(problem.get_next_index(), -1);
+    for (int i = 0; i < problem.items.size(); i++)
+    {
+        size_of[problem.items[i].getIndex()] = problem.items[i].get_size();
+    }
+    return size_of;
+}
+
+/**
+ * This function is used to check a packing in O(n): every item index of the instance must appear exactly once, no other
+ * index may appear, and the load of every bin recomputed from the sizes must not exceed the capacity.
+ *
+ * @param size_of       vector<int> reference type, the size of every index, -1 for an index that is not in the instance.
+ * @param capacity      int type, the capacity of bins.
+ * @param packing       vector<vector<int>> reference type, the item indexes of every bin.
+ * @return              string type, empty if the packing is feasible, otherwise the first fault found.
+ */
+string check_packing(vector<int> &size_of, int capacity, vector<vector<int>> &packing)
+{
+    vector<bool> seen(size_of.size(), false);
+    int num_seen = 0;
+    int num_items = 0;
+    for (int i = 0; i < size_of.size(); i++)
+    {
+        num_items += size_of[i] >= 0;
+    }
+    for (int i = 0; i < packing.size(); i++)
+    {
+        long long load = 0;
+        for (int k = 0; k < packing[i].size(); k++)
+        {
+            int index = packing[i][k];
+            if (index < 0 || index >= size_of.size() || size_of[index] < 0)
             {
-                return false;
+                return "bin " + to_string(i) + " has unknown item " + to_string(index);
             }
-            if (a[i].get_cap_left() != b[i].get_cap_left() && first)
+            if (seen[index])
             {
-                diffA = i;
-                first = false;
+                return "item " + to_string(index) + " is packed twice";
             }
-            else if (a[i].get_cap_left() != b[i].get_cap_left() && !first)
+            seen[index] = true;
+            num_seen++;
+            load += size_of[index];
+        }
+        if (load > capacity)
+        {
+            return "bin " + to_string(i) + " holds " + to_string(load) + " over the capacity " + to_string(capacity);
+        }
+    }
+    if (num_seen != num_items)
+    {
+        return to_string(num_items - num_seen) + " items are not packed";
+    }
+    return "";
+}
+
+/**
+ * This function is used to check bins: the packing must be feasible as for check_packing, every item must keep its size,
+ * and the residual capacity and the size histogram kept by every bin must match its items. The histogram is rebuilt from
+ * the items of the bin and compared entry by entry, so a wrong size or count and a broken largest-first order are found.
+ * Sorting the sizes of every bin makes it O(n log n) at most.
+ *
+ * @param size_of       vector<int> reference type, the size of every index, -1 for an index that is not in the instance.
+ * @param capacity      int type, the capacity of bins.
+ * @param bins          vector<Bin> reference type, the bins.
+ * @return              string type, empty if the bins are right, otherwise the first fault found.
+ */
+string check_bins(vector<int> &size_of, int capacity, vector<Bin> &bins)
+{
+    vector<vector<int>> packing(bins.size());
+    for (int i = 0; i < bins.size(); i++)
+    {
+        int load = 0;
+        for (int k = 0; k < bins[i].packed_items.size(); k++)
+        {
+            Item item = bins[i].packed_items[k];
+            if (item.getIndex() >= 0 && item.getIndex() < size_of.size() && size_of[item.getIndex()] != item.get_size())
             {
-                diffB = i;
-                break;
+                return "item " + to_string(item.getIndex()) + " has size " + to_string(item.get_size()) + " instead of " + to_string(size_of[item.getIndex()]);
             }
+            packing[i].push_back(item.getIndex());
+            load += item.get_size();
         }
-        /**
-         * If the absolute value of the difference between the residual capacity of the two after-disposed
-         * bins is larger than the absolute value of the difference between the residual capacity of the
-         * two before-disposed bins, then the new solution is better.
-         */
-        k = abs(a[diffA].get_cap_left() - a[diffB].get_cap_left()) - abs(b[diffA].get_cap_left() - b[diffB].get_cap_left());
-        if (k >= 0)
+        if (bins[i].get_cap_left() != capacity - load)
         {
-            return true;
+            return "bin " + to_string(i) + " has residual capacity " + to_string(bins[i].get_cap_left()) + " instead of " + to_string(capacity - load);
         }
-        else
+        vector<int> sizes;
+        for (int k = 0; k < bins[i].packed_items.size(); k++)
+        {
+            sizes.push_back(bins[i].packed_items[k].get_size());
+        }
+        sort(sizes.begin(), sizes.end(), greater<int>());
+        vector<pair<int, int>> counts; // The histogram rebuilt from the items, largest size first.
+        for (int k = 0; k < sizes.size(); k++)
+        {
+            if (counts.empty() || counts.back().first != sizes[k])
+            {
+                counts.push_back(make_pair(sizes[k], 0));
+            }
+            counts.back().second++;
+        }
+        if (counts.size() != bins[i].size_counts.size())
+        {
+            return "bin " + to_string(i) + " counts " + to_string(bins[i].size_counts.size()) + " sizes for " + to_string(counts.size()) + " distinct sizes";
+        }
+        for (int k = 0; k < counts.size(); k++)
+        {
+            if (bins[i].size_counts[k] != counts[k])
+            {
+                return "bin " + to_string(i) + " counts " + to_string(bins[i].size_counts[k].second) + " items of size " + to_string(bins[i].size_counts[k].first) + " at " + to_string(k) + " instead of " + to_string(counts[k].second) + " of size " + to_string(counts[k].first);
+            }
+        }
+    }
+    return check_packing(size_of, capacity, packing);
+}
+
+/**
+ * This class is a pool of workers for splitting a loop into tasks. Every worker has its own queue: it takes its newest
+ * task first and, when its queue is empty, steals the oldest task of another queue, so the workers that finish early help
+ * the others. The thread that calls parallel_for steals tasks as well until its loop is done.
+ */
+class WorkStealingPool
+{
+public:
+    WorkStealingPool(int);             // Constructor of WorkStealingPool, start the workers.
+    ~WorkStealingPool();               // Destructor of WorkStealingPool, stop the workers.
+    void parallel_for(int, int, int, function<void(int, int)>); // Run a loop split into ranges.
+    const int get_num_workers();       // Get the number of workers.
+private:
+    struct TaskQueue
+    {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+    bool run_one(int);                 // Run a task of its own queue or a stolen one.
+    void work(int);                    // The loop run by every worker.
+    vector<unique_ptr<TaskQueue>> queues; // One queue per worker.
+    vector<thread> workers;
+    atomic<int> pending;               // The tasks queued and not taken yet.
+    mutex sleep_lock;
+    condition_variable wake;
+    bool stopping;
+};
+
+/**
+ * This function is the constructor of WorkStealingPool and starts the workers.
+ *
+ * @param num_workers   int type, the number of workers, at least one worker is started.
+ */
+WorkStealingPool::WorkStealingPool(int num_workers)
+{
+    pending = 0;
+    stopping = false;
+    num_workers = max(1, num_workers);
+    for (int i = 0; i < num_workers; i++)
+    {
+        queues.push_back(unique_ptr<TaskQueue>(new TaskQueue()));
+    }
+    for (int i = 0; i < num_workers; i++)
+    {
+        workers.push_back(thread(&WorkStealingPool::work, this, i));
+    }
+}
+
+/**
+ * This function is the destructor of WorkStealingPool and stops the workers.
+ */
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        lock_guard<mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (int i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+
+/**
+ * This function is used to get the number of workers.
+ *
+ * @return              int type, the number of workers.
+ */
+const int WorkStealingPool::get_num_workers()
+{
+    return workers.size();
+}
+
+/**
+ * This function is used to run a task: the newest of the own queue, or else the oldest of another queue.
+ *
+ * @param self          int type, the queue of the caller, or -1 for a thread that has no queue.
+ * @return              bool type, false if every queue is empty.
+ */
+bool WorkStealingPool::run_one(int self)
+{
+    function<void()> task;
+    if (self >= 0)
+    {
+        lock_guard<mutex> guard(queues[self]->lock);
+        if (!queues[self]->tasks.empty())
+        {
+            task = queues[self]->tasks.back();
+            queues[self]->tasks.pop_back();
+        }
+    }
+    for (int i = 1; !task && i <= queues.size(); i++)
+    { // Steal from the others, starting from the next queue.
+        int victim = (self + i + queues.size()) % queues.size();
+        lock_guard<mutex> guard(queues[victim]->lock);
+        if (!queues[victim]->tasks.empty())
+        {
+            task = queues[victim]->tasks.front();
+            queues[victim]->tasks.pop_front();
+        }
+    }
+    if (!task)
+    {
+        return false;
+    }
+    pending--;
+    task();
+    return true;
+}
+
+/**
+ * This function is the loop of every worker: run tasks while there are some, then sleep until new ones are queued.
+ *
+ * @param self          int type, the queue of the worker.
+ */
+void WorkStealingPool::work(int self)
+{
+    while (true)
+    {
+        if (run_one(self))
+        {
+            continue;
+        }
+        unique_lock<mutex> guard(sleep_lock);
+        wake.wait(guard, [this]
+                  { return stopping || pending > 0; });
+        if (stopping)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * This function is used to run body on the ranges [begin, end) split into pieces of grain, spread over the queues of the
+ * workers. It returns when all the ranges are done, the calling thread runs or steals tasks meanwhile.
+ *
+ * @param begin         int type, the first index.
+ * @param end           int type, the index after the last.
+ * @param grain         int type, the length of a range.
+ * @param body          function<void(int, int)> type, the work on a range.
+ */
+void WorkStealingPool::parallel_for(int begin, int end, int grain, function<void(int, int)> body)
+{
+    atomic<int> remaining((end - begin + grain - 1) / grain);
+    int target = 0;
+    for (int first = begin; first < end; first += grain)
+    {
+        int last = min(end, first + grain);
+        {
+            lock_guard<mutex> guard(queues[target]->lock);
+            queues[target]->tasks.push_back([first, last, &body, &remaining]
+                                            {
+                body(first, last);
+                remaining--; });
+        }
+        pending++;
+        target = (target + 1) % queues.size();
+    }
+    {
+        lock_guard<mutex> guard(sleep_lock);
+    }
+    wake.notify_all();
+    while (remaining > 0)
+    {
+        if (!run_one(-1))
+        {
+            this_thread::yield(); // The last ranges are being run by the workers.
+        }
+    }
+}
+
+/**
+ * The number of bins from which the exchange neighborhoods are searched in parallel when a pool is given, below it the
+ * cost of the tasks is larger than the search.
+ */
+const int PARALLEL_BINS = 10000;
+
+/**
+ * The number of items with conflicts up to which the conflicts are kept as an adjacency bitset, 32MB at most. Above it
+ * the bitset would not fit in memory and every item keeps the sorted list of its conflicts instead.
+ */
+const int DENSE_CONFLICTS = 16384;
+
+/**
+ * This class is the side constraints of an instance: the maximum number of items in a bin and the pairs of items that
+ * must not share a bin. The conflicts are kept as an adjacency bitset over the items that have at least one conflict, so a
+ * pair is checked in O(1), an item without conflict is never checked, and an item joins a bin after one test per item of
+ * the bin. With more than DENSE_CONFLICTS such items, a pair is checked by a binary search in O(log degree).
+ */
+class Constraints
+{
+public:
+    Constraints(int, vector<pair<int, int>>); // Constructor of Constraints.
+    const int get_max_items();                // Get the maximum number of items in a bin.
+    bool conflict(int, int);                  // Whether two item indexes must not share a bin.
+    const bool has_conflicts();               // Whether any items must not share a bin.
+    bool has_conflicts(int);                  // Whether an item index must not share a bin with some other.
+    vector<int> neighbors(int);               // Get the item indexes in conflict with an item index.
+    bool fits(Bin &, Item &, int);            // Whether an item may join a bin in place of one of its items.
+    string check(vector<int> &);              // Check the item indexes of a bin.
+private:
+    int max_items;
+    vector<int> row; // The row of every item index in the bitset, -1 for the items without conflict.
+    vector<int> index_of; // The item index of every row.
+    int words;       // The 64-bit words of a row.
+    vector<uint64_t> bits;
+    vector<vector<int>> adjacency; // The sorted conflicts of every row, when there is no bitset.
+};
+
+/**
+ * This function is the constructor of Constraints and builds the adjacency bitset.
+ *
+ * @param max_items     int type, the maximum number of items in a bin, 0 for no maximum.
+ * @param conflicts     vector<pair<int, int>> type, the pairs of item indexes that must not share a bin.
+ */
+Constraints::Constraints(int max_items, vector<pair<int, int>> conflicts)
+{
+    this->max_items = max_items;
+    int num_rows = 0;
+    for (int i = 0; i < conflicts.size(); i++)
+    {
+        int ends[2] = {conflicts[i].first, conflicts[i].second};
+        for (int k = 0; k < 2; k++)
+        {
+            if (ends[k] >= row.size())
+            {
+                row.resize(ends[k] + 1, -1);
+            }
+            if (row[ends[k]] == -1)
+            {
+                row[ends[k]] = num_rows++;
+                index_of.push_back(ends[k]);
+            }
+        }
+    }
+    if (num_rows > DENSE_CONFLICTS)
+    {
+        words = 0;
+        adjacency.resize(num_rows);
+        for (int i = 0; i < conflicts.size(); i++)
+        {
+            adjacency[row[conflicts[i].first]].push_back(row[conflicts[i].second]);
+            adjacency[row[conflicts[i].second]].push_back(row[conflicts[i].first]);
+        }
+        for (int i = 0; i < num_rows; i++)
+        {
+            sort(adjacency[i].begin(), adjacency[i].end());
+        }
+        return;
+    }
+    words = (num_rows + 63) / 64;
+    bits.assign((size_t)num_rows * words, 0);
+    for (int i = 0; i < conflicts.size(); i++)
+    {
+        int a = row[conflicts[i].first];
+        int b = row[conflicts[i].second];
+        bits[(size_t)a * words + b / 64] |= 1ULL << (b % 64);
+        bits[(size_t)b * words + a / 64] |= 1ULL << (a % 64);
+    }
+}
+
+/**
+ * This function is used to get the maximum number of items in a bin.
+ *
+ * @return              int type, the maximum number of items in a bin, 0 for no maximum.
+ */
+const int Constraints::get_max_items()
+{
+    return max_items;
+}
+
+/**
+ * This function is used to know whether two items must not share a bin.
+ *
+ * @param a             int type, the index of an item.
+ * @param b             int type, the index of another item.
+ * @return              bool type, true if the items are in conflict.
+ */
+bool Constraints::conflict(int a, int b)
+{
+    if (a >= row.size() || b >= row.size() || row[a] == -1 || row[b] == -1)
+    {
+        return false;
+    }
+    if (words == 0)
+    {
+        return binary_search(adjacency[row[a]].begin(), adjacency[row[a]].end(), row[b]);
+    }
+    return (bits[(size_t)row[a] * words + row[b] / 64] >> (row[b] % 64)) & 1;
+}
+
+/**
+ * This function is used to know whether any items must not share a bin.
+ *
+ * @return              bool type, true if there is at least one conflict.
+ */
+const bool Constraints::has_conflicts()
+{
+    return !index_of.empty();
+}
+
+/**
+ * This function is used to know whether an item must not share a bin with some other item.
+ *
+ * @param index         int type, the index of the item.
+ * @return              bool type, true if the item is in at least one conflict.
+ */
+bool Constraints::has_conflicts(int index)
+{
+    return index < row.size() && row[index] != -1;
+}
+
+/**
+ * This function is used to get the items in conflict with an item, from its sorted list or by a scan of its row of the
+ * bitset.
+ *
+ * @param index         int type, the index of the item.
+ * @return              vector<int> type, the indexes of the items in conflict with it.
+ */
+vector<int> Constraints::neighbors(int index)
+{
+    vector<int> found;
+    if (!has_conflicts(index))
+    {
+        return found;
+    }
+    if (words == 0)
+    {
+        for (int k = 0; k < adjacency[row[index]].size(); k++)
+        {
+            found.push_back(index_of[adjacency[row[index]][k]]);
+        }
+        return found;
+    }
+    const uint64_t *bitrow = &bits[(size_t)row[index] * words];
+    for (int w = 0; w < words; w++)
+    {
+        uint64_t word = bitrow[w];
+        for (int b = 0; word != 0; b++, word >>= 1)
+        {
+            if (word & 1)
+            {
+                found.push_back(index_of[w * 64 + b]);
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * This function is used to know whether an item may join a bin, possibly in place of an item that leaves the bin.
+ *
+ * @param bin           Bin reference type, the bin.
+ * @param item          Item reference type, the item that joins the bin.
+ * @param leaving       int type, the position of the item that leaves the bin, -1 if none leaves.
+ * @return              bool type, true if the constraints still hold.
+ */
+bool Constraints::fits(Bin &bin, Item &item, int leaving)
+{
+    if (max_items > 0 && bin.packed_items.size() + (leaving == -1 ? 1 : 0) > max_items)
+    {
+        return false;
+    }
+    int index = item.getIndex();
+    if (index >= row.size() || row[index] == -1)
+    {
+        return true;
+    }
+    for (int k = 0; k < bin.packed_items.size(); k++)
+    {
+        if (k != leaving && conflict(index, bin.packed_items[k].getIndex()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * This function is used to check the constraints on the item indexes of a bin.
+ *
+ * @param indexes       vector<int> reference type, the item indexes of the bin.
+ * @return              string type, the first constraint broken, empty if there is none.
+ */
+string Constraints::check(vector<int> &indexes)
+{
+    if (max_items > 0 && indexes.size() > max_items)
+    {
+        return to_string(indexes.size()) + " items over the maximum " + to_string(max_items);
+    }
+    for (int i = 0; i < indexes.size(); i++)
+    {
+        for (int k = i + 1; k < indexes.size(); k++)
+        {
+            if (conflict(indexes[i], indexes[k]))
+            {
+                return "items " + to_string(indexes[i]) + " and " + to_string(indexes[k]) + " are in conflict";
+            }
+        }
+    }
+    return "";
+}
+
+/**
+ * This function is used to read the conflicts of the instances. An instance starts with its identifier line beginning with
+ * a quote as in the data file, followed by one line "<index> <index>" for every pair of items that must not share a bin.
+ *
+ * @param inFile        istream reference type, the file of conflicts.
+ * @return              map<string, vector<pair<int, int>>> type, the pairs of item indexes by the instance identifier.
+ */
+map<string, vector<pair<int, int>>> read_conflicts(istream &inFile)
+{
+    map<string, vector<pair<int, int>>> conflicts;
+    vector<pair<int, int>> *pairs = nullptr;
+    string str;
+    while (getline(inFile, str))
+    {
+        if (!str.empty() && str.back() == '\r')
+        {
+            str.pop_back();
+        }
+        if (str.empty())
+        {
+            continue;
+        }
+        if (str[0] == '\'')
+        {
+            pairs = &conflicts[str.substr(1)];
+        }
+        else if (pairs != nullptr)
+        {
+            int a = -1;
+            int b = -1;
+            istringstream(str) >> a >> b;
+            if (a >= 0 && b >= 0 && a != b)
+            {
+                pairs->push_back(make_pair(a, b));
+            }
+        }
+    }
+    return conflicts;
+}
+
+/**
+ * This class is the settings of the search that are not options of a run, so that they can be tuned by tools/tune.cpp.
+ * crack_120:       the slack relaxed mbs allows in a bin for the instances of 120 items.
+ * crack_500:       the slack relaxed mbs allows in a bin for the instances of 500 items.
+ * crack_other:     the slack relaxed mbs allows in a bin for the instances of any other number of items.
+ * neighborhood:    how many of the 4 neighborhoods VNS uses.
+ * shake_timeout:   how long shaking looks for a swap before giving up, in seconds.
+ * split_ratio:     the part of the items of a bin that split moves to a new bin.
+ */
+struct SearchConfig
+{
+    int crack_120 = 3;
+    int crack_500 = 5;
+    int crack_other = 11000;
+    int neighborhood = 2;
+    double shake_timeout = 1;
+    double split_ratio = 0.5;
+};
+
+/**
+ * This function is used to read the settings of the search from "key=value" words, the keys are the names of the
+ * settings and the settings not given keep their values.
+ *
+ * @param inFile        istream reference type, the words.
+ * @param config        SearchConfig reference type, the settings to change.
+ * @return              bool type, false if a word is not a setting.
+ */
+bool read_config(istream &inFile, SearchConfig &config)
+{
+    string word;
+    while (inFile >> word)
+    {
+        size_t equal = word.find('=');
+        string key = word.substr(0, equal);
+        const char *value = equal == string::npos ? "" : word.c_str() + equal + 1;
+        if (equal == string::npos || *value == '\0')
+        {
+            return false;
+        }
+        if (key == "crack_120")
+        {
+            config.crack_120 = atoi(value);
+        }
+        else if (key == "crack_500")
+        {
+            config.crack_500 = atoi(value);
+        }
+        else if (key == "crack_other")
+        {
+            config.crack_other = atoi(value);
+        }
+        else if (key == "neighborhood")
+        {
+            config.neighborhood = atoi(value);
+        }
+        else if (key == "shake_timeout")
+        {
+            config.shake_timeout = atof(value);
+        }
+        else if (key == "split_ratio")
+        {
+            config.split_ratio = atof(value);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * This function is used to write the settings of the search as "key=value" words on a line, as read by read_config.
+ *
+ * @param out           ostream reference type, where the settings are written.
+ * @param config        const SearchConfig reference type, the settings.
+ */
+void write_config(ostream &out, const SearchConfig &config)
+{
+    out << "crack_120=" << config.crack_120 << " crack_500=" << config.crack_500 << " crack_other=" << config.crack_other
+        << " neighborhood=" << config.neighborhood << " shake_timeout=" << config.shake_timeout
+        << " split_ratio=" << config.split_ratio << endl;
+}
+
+/**
+ * This class is used to report the search while it runs: every new best number of bins is appended to a progress file as
+ * an event (seconds since the start, identifier, bins, abs-gap), and the solutions are written to a checkpoint file at a
+ * fixed interval, so a killed job can resume from the checkpoint with --resume. The search thread only queues the events
+ * and copies the best bins, all the writing is done by a background thread.
+ */
+class Progress
+{
+public:
+    Progress(string, string, double);      // Constructor of Progress, start the writer.
+    ~Progress();                           // Destructor of Progress, write what is left and stop the writer.
+    void start(string, int, vector<Bin>);  // Begin an instance with its fixed bins.
+    void improved(vector<Bin> &);          // Record a new best of the current instance.
+    void finish(vector<Bin> &);            // Record the final bins of the current instance.
+private:
+    void write();                          // The loop of the writer.
+    void write_checkpoint();               // Write all the solutions known so far to the checkpoint file.
+    ofstream progressFile;
+    string checkpoint_file;
+    double interval;
+    chrono::steady_clock::time_point startTime;
+    vector<string> events;                 // The events not written yet.
+    string finished;                       // The solutions of the finished instances in the solution format.
+    int num_finished;
+    string identifier;                     // The current instance.
+    int best_known;
+    vector<Bin> fixed;
+    vector<Bin> best;
+    bool dirty;                            // Whether the checkpoint is older than the known solutions.
+    bool stopping;
+    mutex lock;
+    condition_variable wake;
+    thread writer;
+};
+
+/**
+ * This class is used to store the information of the solution like the packed bins, the number of bins, the abs-gap and
+ * all the disposal of the bins and items including: relaxed minimum bin slack to get the initial solution. And the variable
+ * neighborhood search(VNS) to improve the solution to reduce bins. The VNS can be divided into two parts:Variable neighborhood
+ * descent(VND) and Shaking procedure. And a fitness function to evaluate the better solution.
+ *
+ * VND(4 actions):
+ * 1. shift: This action selects a item from the bin that has the largest residual capacity and tries to move the smallest item
+ * to the rest of bins by using best fit descent.
+ * 2. exchange_largest: This action picks the largest item from the item which has the maximal residual capacity and tries to
+ * change it with another smaller item from other bins by using best fit descent.
+ * 3: exchange_smallest: This action picks the smallest item from the item which has the maximal residual capacity and tries to
+ * change it with another smaller item from other bins by using best fit descents.
+ * 4: split: This action randomly select half items from a bin that exceeds the average items per bin to a new bin.
+ *
+ * Shaking procedure: The shaking procedure is to randomly select two items from two different bins and swap the two items.
+ *
+ * Fitness function:
+ * 1. If the new solution has fewer bins, then the new solution is better.
+ * 2. If the new solution has the same bins with the old one, then compare the two bins that have been disposed.
+ * If the absolute value of the difference between the residual capacity of the two after-disposed bins is larger than the
+ * absolute value of the difference between the residual capacity of the two before-disposed bins, then the new solution is better.
+ * 3. If the new solution has more bins, then compare the items in the new bin and the bin with the maximal residual capacity.
+ * If there is one item in the new bin has fewer size than any item in the bin with the maximal residual capacity, then the new
+ * solution is better.
+ */
+class Solution
+{
+public:
+    Solution(Problem);                                 // The constructor the class Solution.
+    void set_objective(int);                           // Set the objective for each problem instance.
+    const string get_identifier();                     // Get the identifier for the problem instance.
+    const float get_objective();                       // Get the objective for each problem instance.
+    const int get_capacity();                          // Get the capacity for each problem instance.
+    const float get_abs_gap();                         // Get the abs_gap for each problem instance.
+    void set_bins(vector<Bin>);                        // Set the bins for the problem instance.
+    void minimumBinSlack(int, int, int, Bin, Problem); // Relaxed mbs for a single bin.
+    void initialize(int, Problem);                     // The process of get initial solution.
+    bool warm_start(vector<vector<int>>, Problem);     // Get the initial solution from a previous packing.
+    void initialize_large(Problem &);                  // The process of get initial solution for large instances.
+    bool initialize_dp(Problem &, const atomic<bool> *, double); // The process of get a solution by filling every bin by dp.
+    vector<Bin> get_bins();                            // Get the current bins of the instance.
+    vector<Bin> shift(vector<Bin> &);                  // Heuristic 1.
+    vector<Bin> exchange_largest(vector<Bin> &);       // heuristic 2.
+    vector<Bin> exchange_smallest(vector<Bin> &);      // Heuristic 3.
+    vector<Bin> split(vector<Bin> &);                  // Heuristic 4.
+    vector<Bin> shaking(vector<Bin> &);                // Shaking procedure by swapping two items randomly.
+    vector<Bin> VNS(double);                           // Variable neighbor search.
+    bool evaluation(vector<Bin> &, vector<Bin> &);     // Fitness function to evaluate the current solution.
+    void set_cancel(const atomic<bool> *);             // Set the flag that stops VNS early when it is raised.
+    void set_move_limit(int);                          // Set the maximum neighborhood moves of VNS.
+    void set_shake_timeout(double);                    // Set how long shaking looks for a swap before giving up.
+    void set_seed(unsigned);                           // Set the seed of the random choices of split and shaking.
+    void set_neighborhood(int);                        // Set how many of the 4 neighborhoods VNS uses.
+    void set_config(const SearchConfig &);             // Set the settings of the search.
+    void set_progress(Progress *);                     // Set where VNS reports every new best solution.
+    void check_move(vector<int> &, vector<Bin> &, int); // Stop the program if a move has broken the bins.
+    void set_pool(WorkStealingPool *);                 // Set the workers that search the large neighborhoods.
+    void find_exchange(vector<Bin> &, int, int, int &, int &, int &); // Find the best item to swap with an item.
+    void set_constraints(Constraints *);               // Set the side constraints every move must keep.
+    void set_target(int);                              // Set the number of bins at which VNS stops.
+    void initialize_constrained(Problem &);            // The process of get initial solution for large constrained instances.
+    void apply_delta(Problem &, vector<int>, vector<int>); // Add and remove items and repair the bins locally.
+    void set_bin_types(vector<BinType>, Problem &);   // Minimise the cost of the bins of several types.
+    long long get_cost(vector<Bin> &);                 // Get the total cost of the bins.
+    bool assign_types(vector<Bin> &);                  // Give every bin its bin type within the limits.
+    void initialize_types(Problem &, bool);            // The process of get initial solution with bin types.
+    long long get_excess(vector<Bin> &);               // Get how many bins are over the limits of the bin types.
+    const bool is_within_limits();                     // Whether the last bin types given are within the limits.
+
+private:
+    string identifier;
+    int capacity;
+    float objective;
+    float abs_gap;
+    int best_known;
+    vector<Bin> bins;
+    const atomic<bool> *cancel;
+    int move_limit;
+    double shake_timeout;
+    double split_ratio;
+    int neighborhood;
+    mt19937 rng;
+    Progress *progress;
+    WorkStealingPool *pool;
+    Constraints *constraints;
+    int target;
+    vector<BinType> bin_types;
+    vector<int> load_cost; // The cost of the cheapest bin type that holds every load, empty for uniform bins.
+    vector<int> load_class;       // The class of the smallest bin types that hold every load, empty without limits.
+    vector<long long> class_room; // The bins the types of every class and of the larger classes allow.
+    bool within_limits;
+    void count_load(vector<int> &, int, int);          // Count a load in its class of bin types.
+    vector<int> count_classes(vector<Bin> &);          // Count the bins of every class of bin types.
+    long long class_excess(vector<int> &);             // Get how many bins are over the limits from their classes.
+    long long move_excess(vector<int> &, int, int, int, int); // Get the bins over the limits after two bins change load.
+};
+
+/**
+ * This function is constructor of class Solution. This constructor initializes the identifier, capacity, best known solution
+ * and prepare enough bins to pack all items.
+ *
+ * @param problem       Problem type, a whole instance.
+ */
+Solution::Solution(Problem problem)
+{
+    this->identifier = problem.get_identifier();
+    this->capacity = problem.get_capacity();
+    this->best_known = problem.get_best_solution();
+    this->cancel = nullptr;
+    this->move_limit = 0;
+    this->shake_timeout = 1;
+    this->split_ratio = 0.5;
+    this->neighborhood = 2;
+    this->rng.seed(time(NULL));
+    this->progress = nullptr;
+    this->pool = nullptr;
+    this->constraints = nullptr;
+    this->target = 0;
+    this->within_limits = true;
+    for (int i = 0; i < problem.items.size(); i++)
+    {
+        Bin bin(capacity);
+        bins.push_back(bin);
+    }
+}
+
+/**
+ * This function is used to pack items for every single bin by using relaxed minimum bin slack.
+ *
+ * @param crack         int type, the permitted crack of a bin.
+ * @param initial       int type, the beginning index of an item.
+ * @param chosen        int type, the chosen index of a bin.
+ * @param bin           Bin type, a bin to pack items.
+ * @param problem       Problem problem, problem instance.
+ */
+void Solution::minimumBinSlack(int crack, int initial, int chosen, Bin bin, Problem problem)
+{
+    for (int i = initial; i < problem.items.size(); i++)
+    {
+        if (problem.items[i].get_size() <= bin.get_cap_left() && (constraints == nullptr || constraints->fits(bin, problem.items[i], -1)))
+        { // The item fits and keeps the constraints of the bin.
+            bin.encase(problem.items[i]);
+            minimumBinSlack(crack, i + 1, chosen, bin, problem);                       // Recursive to the next.
+            bin.remove(bin.packed_items.size() - 1); // Move out the last fo find a more suitable item.
+            if (bins[chosen].get_cap_left() <= crack)
+            {
+                return;
+            }
+        }
+    }
+    if (bin.get_cap_left() < bins[chosen].get_cap_left())
+    { // If the bin has fewer residual capacity, then select it.
+        bins[chosen] = bin;
+    }
+}
+
+/**
+ * This function is used to initialize the solution by using relaxed minimum bin slack until every items are packed.
+ *
+ * @param crack         int type, the permitted crack.
+ * @param problem       Problem type , the instance.
+ */
+void Solution::initialize(int crack, Problem problem)
+{
+    int chosenBinIndex = 0;
+    while (problem.items.size() != 0)
+    {
+        bins[chosenBinIndex].encase(problem.items[0]); // Pack one first.
+        Bin bridgeBin = bins[chosenBinIndex];
+        problem.deleteItem(problem.items[0]);
+        /**
+         * Remove all the empty bins in one pass.
+         */
+        if (problem.items.empty())
+        {
+            bins.erase(remove_if(bins.begin(), bins.end(), [](Bin bin)
+                                 { return bin.packed_items.empty(); }),
+                       bins.end());
+            set_objective(bins.size());
+            return;
+        }
+        minimumBinSlack(crack, 0, chosenBinIndex, bridgeBin, problem); // For every bin.
+        for (int i = 0; i < bins[chosenBinIndex].packed_items.size(); i++)
+        {
+            problem.deleteItem(bins[chosenBinIndex].packed_items[i]); // Remove the packed items.
+        }
+        chosenBinIndex++;
+    }
+    /**
+     * Remove all the empty bins in one pass.
+     */
+    bins.erase(remove_if(bins.begin(), bins.end(), [](Bin bin)
+                         { return bin.packed_items.empty(); }),
+               bins.end());
+    set_objective(bins.size());
+}
+
+/**
+ * This function is used to initialize the solution of a large instance by best fit decreasing in O(n log n), as relaxed
+ * mbs scans all the remaining items for every bin.
+ *
+ * @param problem       Problem reference type, the instance.
+ */
+void Solution::initialize_large(Problem &problem)
+{
+    vector<int> bin_of;
+    int num_bins = best_fit(problem, bin_of);
+    bins.assign(num_bins, Bin(capacity));
+    for (int i = 0; i < problem.items.size(); i++)
+    {
+        bins[bin_of[i]].encase(problem.items[i]);
+    }
+    set_objective(bins.size());
+}
+
+/**
+ * This function is used to get a solution by filling the bins one by one as full as possible, which is the minimum bin
+ * slack of every bin found exactly by dynamic programming instead of by a search. The largest item left opens the bin,
+ * the loads reachable with the first items are kept as one bitset per item, so that the fullest load is read from the last
+ * bitset and its items are found by going back through the bitsets. A bin costs O(m * capacity / 64) for the m items left,
+ * so this suits the instances of few large items.
+ *
+ * @param problem       Problem reference type, the instance.
+ * @param cancel        const atomic<bool> pointer type, the flag that stops the packing early, nullptr if never.
+ * @param max_time      double type, the maximum time of the packing in seconds.
+ * @return              bool type, false if the packing has been stopped before every item is packed.
+ */
+bool Solution::initialize_dp(Problem &problem, const atomic<bool> *cancel, double max_time)
+{
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    vector<Item> left = problem.items;
+    int words = capacity / 64 + 1;
+    uint64_t last_mask = capacity % 64 == 63 ? ~0ULL : (1ULL << (capacity % 64 + 1)) - 1; // The loads up to the capacity.
+    vector<Bin> packed;
+    while (!left.empty())
+    {
+        if ((cancel != nullptr && cancel->load(memory_order_relaxed)) || chrono::duration<double>(chrono::steady_clock::now() - startTime).count() >= max_time)
+        {
+            return false;
+        }
+        if (left[0].get_size() > capacity)
+        { // An item larger than the capacity gets a bin of its own, its load has no bit.
+            Bin bin(capacity);
+            bin.encase(left[0]);
+            packed.push_back(bin);
+            left.erase(left.begin());
+            continue;
+        }
+        vector<uint64_t> reach((size_t)left.size() * words, 0); // The loads reachable with the items before and including each.
+        int first = left[0].get_size();
+        reach[first / 64] = 1ULL << (first % 64);
+        for (int k = 1; k < left.size(); k++)
+        {
+            uint64_t *before = &reach[(size_t)(k - 1) * words];
+            uint64_t *after = &reach[(size_t)k * words];
+            int size = left[k].get_size();
+            int jump = size / 64;
+            int bit = size % 64;
+            for (int w = 0; w < words; w++)
+            { // after = before | before << size.
+                uint64_t moved = 0;
+                if (w >= jump)
+                {
+                    moved = before[w - jump] << bit;
+                    if (bit != 0 && w > jump)
+                    {
+                        moved |= before[w - jump - 1] >> (64 - bit);
+                    }
+                }
+                after[w] = before[w] | moved;
+            }
+            after[words - 1] &= last_mask;
+        }
+        int load = capacity;
+        uint64_t *last = &reach[(size_t)(left.size() - 1) * words];
+        while (!((last[load / 64] >> (load % 64)) & 1))
+        {
+            load--;
+        }
+        Bin bin(capacity);
+        vector<bool> taken(left.size(), false);
+        for (int k = left.size() - 1; k > 0; k--)
+        { // The item is in the bin if the load can not be reached without it.
+            uint64_t *before = &reach[(size_t)(k - 1) * words];
+            if (!((before[load / 64] >> (load % 64)) & 1))
+            {
+                taken[k] = true;
+                load -= left[k].get_size();
+            }
+        }
+        taken[0] = true;
+        vector<Item> rest;
+        for (int k = 0; k < left.size(); k++)
+        {
+            if (taken[k])
+            {
+                bin.encase(left[k]);
+            }
+            else
+            {
+                rest.push_back(left[k]);
+            }
+        }
+        packed.push_back(bin);
+        left = rest;
+    }
+    bins = packed;
+    set_objective(bins.size());
+    return true;
+}
+
+/**
+ * This function is used to take a previous packing of the same instance as the initial solution instead of relaxed mbs.
+ * The packing is checked against the instance first: every item index must appear exactly once and no bin may exceed
+ * the capacity. If the check fails the bins are left untouched.
+ *
+ * @param packing       vector<vector<int>> type, the item indexes of every bin.
+ * @param problem       Problem type, the instance.
+ * @return              bool type, true if the packing is valid and has been taken.
+ */
+bool Solution::warm_start(vector<vector<int>> packing, Problem problem)
+{
+    vector<int> position(problem.get_next_index(), -1); // Where every item index is in problem.items.
+    vector<bool> packed(problem.get_next_index(), false);
+    vector<Bin> warm;
+    int num_packed = 0;
+    for (int i = 0; i < problem.items.size(); i++)
+    {
+        position[problem.items[i].getIndex()] = i;
+    }
+    for (int i = 0; i < packing.size(); i++)
+    {
+        if (packing[i].empty())
+        {
+            continue;
+        }
+        Bin bin(capacity);
+        for (int k = 0; k < packing[i].size(); k++)
+        {
+            int index = packing[i][k];
+            if (index < 0 || index >= problem.get_next_index() || position[index] == -1 || packed[index])
+            { // Unknown or repeated item.
+                return false;
+            }
+            packed[index] = true;
+            num_packed++;
+            bin.encase(problem.items[position[index]]);
+        }
+        if (bin.get_cap_left() < 0 || (constraints != nullptr && !constraints->check(packing[i]).empty()))
+        { // Over capacity or against the side constraints.
+            return false;
+        }
+        warm.push_back(bin);
+    }
+    if (num_packed != problem.items.size())
+    { // Some items are missing, the items fixed by the reductions are not in the packing.
+        return false;
+    }
+    bins = warm;
+    set_objective(bins.size());
+    return true;
+}
+
+/**
+ * This function is used to change a solved instance when a few items are added or removed, without building the initial
+ * solution again. It is linear in the instance, as the items and the bins are scanned once. The removed items are taken
+ * out of their bins and the emptied bins are dropped. Then the added items
+ * are packed from the largest by best fit into the residual capacities, which are bucketed by value so that the best
+ * bin is found without sorting the bins. A new bin is opened for an item that fits nowhere.
+ *
+ * @param problem       Problem reference type, the instance, it is updated as well.
+ * @param added         vector<int> type, the sizes of the added items.
+ * @param removed       vector<int> type, the indexes of the removed items.
+ */
+void Solution::apply_delta(Problem &problem, vector<int> added, vector<int> removed)
+{
+    vector<Item> fresh = problem.update(added, removed);
+    vector<bool> gone(problem.get_next_index(), false);
+    for (int i = 0; i < removed.size(); i++)
+    {
+        if (removed[i] >= 0 && removed[i] < gone.size())
+        {
+            gone[removed[i]] = true;
+        }
+    }
+    if (!removed.empty())
+    {
+        for (int i = 0; i < bins.size(); i++)
+        {
+            for (int k = bins[i].packed_items.size() - 1; k >= 0; k--)
+            {
+                if (gone[bins[i].packed_items[k].getIndex()])
+                {
+                    bins[i].remove(k);
+                }
+            }
+        }
+        bins.erase(remove_if(bins.begin(), bins.end(), [](Bin bin)
+                             { return bin.packed_items.empty(); }),
+                   bins.end());
+    }
+    if (!fresh.empty())
+    {
+        vector<vector<int>> residual(capacity + 1); // Indexes of the bins by residual capacity.
+        for (int i = 0; i < bins.size(); i++)
+        {
+            if (bins[i].get_cap_left() > 0)
+            {
+                residual[bins[i].get_cap_left()].push_back(i);
+            }
+        }
+        for (int i = 0; i < fresh.size(); i++)
+        { // The added items are already sorted in a decreasing sequence.
+            int size = fresh[i].get_size();
+            int chosen = -1;
+            for (int r = size; r <= capacity; r++)
+            {
+                if (!residual[r].empty())
+                {
+                    chosen = residual[r].back();
+                    residual[r].pop_back();
+                    break;
+                }
+            }
+            if (chosen == -1)
+            {
+                Bin bin(capacity);
+                bins.push_back(bin);
+                chosen = bins.size() - 1;
+            }
+            bins[chosen].encase(fresh[i]);
+            if (bins[chosen].get_cap_left() > 0)
+            {
+                residual[bins[chosen].get_cap_left()].push_back(chosen);
+            }
+        }
+    }
+    set_objective(bins.size());
+}
+
+/**
+ * This function is the variable neighborhood search including 4 neighborhoods to solve bin packing.
+ * VND(4 actions):
+ * 1. shift: This action selects a item from the bin that has the largest residual capacity and tries to move the smallest item
+ * to the rest of bins by using best fit descent.
+ * 2. exchange_largest: This action picks the largest item from the item which has the maximal residual capacity and tries to
+ * change it with another smaller item from other bins by using best fit descent.
+ * 3: exchange_smallest: This action picks the smallest item from the item which has the maximal residual capacity and tries to
+ * change it with another smaller item from other bins by using best fit descents.
+ * 4: split: This action is to randomly select half items from a bin that exceeds the average items per bin
+ * to a new bin.
+ *
+ * Shaking procedure: The shaking procedure picks randomly two items from different bins and swap them.
+ *
+ * Fitness function:
+ * 1. If the new solution has fewer bins, then the new solution is better.
+ * 2. If the new solution has the same bins with the old one, then compare the two bins that have been disposed.
+ * If the absolute value of the difference between the residual capacity of the two after-disposed bins is larger than the
+ * absolute value of the difference between the residual capacity of the two before-disposed bins, then the new solution is better.
+ * 3. If the new solution has more bins, then compare the items in the new bin and the bin with the maximal residual capacity.
+ * If there is one item in the new bin has fewer size than any item in the bin with the maximal residual capacity, then the new
+ * solution is better.
+ *
+ * @param max_time      double type, the maximum time of running a single instance in seconds.
+ * @return              vector<Bin> type, the current bins of the solution.
+ */
+vector<Bin> Solution::VNS(double max_time)
+{
+    vector<Bin> answer = get_bins();
+    vector<Bin> answer_new;
+    vector<Bin> answer_best = answer;
+    if (answer.empty())
+    { // Nothing left to pack, e.g. every item has been fixed by the reductions.
+        return answer;
+    }
+#ifdef BPP_DEBUG
+    /**
+     * Debug build: every accepted move is checked against the items VNS started with.
+     */
+    vector<int> size_of;
+    for (int i = 0; i < answer.size(); i++)
+    {
+        for (int k = 0; k < answer[i].packed_items.size(); k++)
+        {
+            Item item = answer[i].packed_items[k];
+            if (item.getIndex() >= size_of.size())
+            {
+                size_of.resize(item.getIndex() + 1, -1);
+            }
+            size_of[item.getIndex()] = item.get_size();
+        }
+    }
+#endif
+    chrono::steady_clock::time_point startTime, endTime;
+    int num;
+    int moves = 0;
+    /**
+     * 4 neighborhoods. If find a better one then back to the first neighborhood, otherwise search in the next neighborhood.
+     * The time limit is measured on the wall clock, as clock() counts the CPU time of every thread in the process and
+     * would shorten the budget of each request when several instances are solved at the same time in server mode.
+     */
+    startTime = chrono::steady_clock::now();
+    while (true)
+    {
+        if (target > 0 && answer_best.size() <= target)
+        { // The lower bound is reached.
+            return answer_best;
+        }
+        num = 1;
+        while (num <= neighborhood)
+        {
+            endTime = chrono::steady_clock::now();
+            if (chrono::duration<double>(endTime - startTime).count() >= max_time)
+            { // Limit of time.
+                return answer_best;
+            }
+            if (cancel != nullptr && cancel->load(memory_order_relaxed))
+            { // Cancelled by the caller, give back the best found so far.
+                return answer_best;
+            }
+            if (move_limit > 0 && ++moves > move_limit)
+            { // Bounded search, used after a small change of the instance.
+                return evaluation(answer, answer_best) ? answer : answer_best;
+            }
+            if (num == 1)
+            {
+                answer_new = shift(answer); // Heuristic 1.
+            }
+            else if (num == 2)
+            {
+                answer_new = exchange_largest(answer); // Heuristic 2.
+            }
+            else if (num == 3)
+            {
+                answer_new = exchange_smallest(answer); // Heuristic 3.
+            }
+            else
+            {
+                answer_new = split(answer); // Heuristic 4.
+            }
+
+            if (evaluation(answer_new, answer))
+            { // If better, then return to Heuristic1.
+                answer = answer_new;
+#ifdef BPP_DEBUG
+                check_move(size_of, answer, num);
+#endif
+                num = 1;
+                continue;
+            }
+            else
+            {
+                num++;
+            }
+        }
+        if (evaluation(answer, answer_best))
+        { // If the new is better, then set it as best.
+            if (progress != nullptr && answer.size() < answer_best.size())
+            { // Report every new best number of bins.
+                progress->improved(answer);
+            }
+            answer_best = answer;
+        }
+        answer = shaking(answer); // Shaking procedure
+#ifdef BPP_DEBUG
+        check_move(size_of, answer, 0);
+#endif
+    }
+}
+
+/**
+ * This function is used by the debug build to check the bins after every accepted move of VNS. The program stops at
+ * once if the move has broken them, naming the move.
+ *
+ * @param size_of       vector<int> reference type, the size of every item index VNS started with.
+ * @param bins          vector<Bin> reference type, the bins after the move.
+ * @param move          int type, the neighborhood from 1 to 4, or 0 for shaking.
+ */
+void Solution::check_move(vector<int> &size_of, vector<Bin> &bins, int move)
+{
+    const char *names[] = {"shaking", "shift", "exchange_largest", "exchange_smallest", "split"};
+    string error = check_bins(size_of, capacity, bins);
+    for (int i = 0; i < bins.size() && error.empty() && constraints != nullptr; i++)
+    {
+        vector<int> indexes;
+        for (int k = 0; k < bins[i].packed_items.size(); k++)
+        {
+            indexes.push_back(bins[i].packed_items[k].getIndex());
+        }
+        error = constraints->check(indexes);
+    }
+    if (!error.empty())
+    {
+        cerr << identifier << ": " << names[move] << " broke the solution: " << error << endl;
+        abort();
+    }
+}
+
+/**
+ * This function is the fitness function to evaluate the solution.
+ * 1. If the new solution has fewer bins, then the new solution is better.
+ * 2. If the new solution has the same bins with the old one, then compare the two bins that have been disposed.
+ * If the absolute value of the difference between the residual capacity of the two after-disposed bins is larger than the
+ * absolute value of the difference between the residual capacity of the two before-disposed bins, then the new solution is better.
+ * 3. If the new solution has more bins, then compare the items in the new bin and the bin with the maximal residual capacity.
+ * If there is one item in the new bin has fewer size than any item in the bin with the maximal residual capacity, then the new
+ * solution is better.
+ * With bin types, a solution with fewer bins over the limits of the types is better, then a solution of lower total cost
+ * whatever its number of bins, and the rules above are used for the same cost. The cost and the bins of every class of
+ * types are summed bin by bin in the pass that finds the two changed bins, so evaluation stays one pass over the bins.
+ *
+ * @param after         vector<Bin> reference type, the used bins of the new solution.
+ * @param before        vector<Bin> reference type, the used bins of the old solution.
+ * @return              bool type, new one better returns true or old one better returns false.
+ */
+bool Solution::evaluation(vector<Bin> &after, vector<Bin> &before)
+{
+    int diffA = -1;
+    int diffB = -1;
+    long long change = 0; // The cost of the new solution less the cost of the old one.
+    vector<int> after_classes(class_room.size(), 0);
+    vector<int> before_classes(class_room.size(), 0);
+    for (int i = 0; i < after.size() || i < before.size(); i++)
+    {
+        int load_after = i < after.size() ? after[i].get_capacity() - after[i].get_cap_left() : 0;
+        int load_before = i < before.size() ? before[i].get_capacity() - before[i].get_cap_left() : 0;
+        if (after.size() == before.size() && load_after != load_before)
+        { // Find the two bins that swapped items.
+            diffB = diffA == -1 ? -1 : (diffB == -1 ? i : diffB);
+            diffA = diffA == -1 ? i : diffA;
+        }
+        if (load_cost.empty())
+        { // Without bin types only the two changed bins are needed.
+            if (after.size() != before.size() || diffB != -1)
+            {
+                break;
+            }
+            continue;
+        }
+        change += load_cost[load_after] - load_cost[load_before];
+        if (!load_class.empty())
+        {
+            count_load(after_classes, load_after, 1);
+            count_load(before_classes, load_before, 1);
+        }
+    }
+    if (!load_class.empty())
+    { // With limits the bins over them come first.
+        long long excess = class_excess(after_classes) - class_excess(before_classes);
+        if (excess != 0)
+        {
+            return excess < 0;
+        }
+    }
+    if (change != 0)
+    { // With bin types the total cost comes next, the rules below only break the ties.
+        return change < 0;
+    }
+    if (after.size() < before.size())
+    { // If new solution has fewer bins.
+        return true;
+    }
+    else if (after.size() == before.size())
+    { // If has the same number of bins.
+        if (diffB == -1)
+        { // Fewer than two bins have changed.
+            return false;
+        }
+        /**
+         * If the absolute value of the difference between the residual capacity of the two after-disposed
+         * bins is larger than the absolute value of the difference between the residual capacity of the
+         * two before-disposed bins, then the new solution is better.
+         */
+        int k = abs(after[diffA].get_cap_left() - after[diffB].get_cap_left()) - abs(before[diffA].get_cap_left() - before[diffB].get_cap_left());
+        if (k >= 0)
+        {
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else
+    { // If new solution has more bins.
+        int num = -1;
+        int max_left = 0;
+        for (int i = 0; i < before.size(); i++)
+        {
+            if (max_left < before[i].get_cap_left())
+            {
+                max_left = before[i].get_cap_left();
+                num = i;
+            }
+        }
+        if (num == -1 || num >= after.size() - 1)
+        { // Every bin was full, one more bin can not be better.
+            return false;
+        }
+        // If there is one item in the new bin has fewer size than any item in the bin with the maximal residual capacity.
+        for (int i = 0; i < after.back().packed_items.size(); i++)
+        {
+            for (int k = 0; k < after[num].packed_items.size(); k++)
+            {
+                if (after.back().packed_items[i].get_size() < after[num].packed_items[k].get_size())
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
+
+/**
+ * This is the first neighborhood of VNS.
+ * This action selects a item from the bin that has the largest residual capacity and tries to move the smallest item
+ * to the rest of bins by using best fit descent. With bin types, the bin whose cheapest type costs the least more after
+ * taking the item is chosen first, and a bin is not chosen if the move puts more bins over the limits of the types.
+ *
+ * @param answer        vector<Bin> reference type, the used bins of the old solution, left unchanged.
+ * @return              vector<Bin>type, the used bins of the new solution.
+ */
+vector<Bin> Solution::shift(vector<Bin> &answer)
+{
+    int index_max_residual = -1;
+    int index_min_residual = -1;
+    int max_residual = 0;
+    int minimum_cap = get_capacity();
+    int minimum_extra = INT_MAX;
+    for (int i = 0; i < answer.size(); i++)
+    { // Get the index of the bin with the largest residual capacity.
+        if (answer[i].get_cap_left() > max_residual)
+        {
+            max_residual = answer[i].get_cap_left();
+            index_max_residual = i; // Index of max residual.
+        }
+    }
+    if (index_max_residual == -1)
+    { // Every bin is full, nothing to move out.
+        return answer;
+    }
+    vector<int> counts;
+    long long excess = 0;
+    int load_out = get_capacity() - answer[index_max_residual].get_cap_left();
+    if (!load_class.empty())
+    { // The bins of every class of types, to keep the limits.
+        counts = count_classes(answer);
+        excess = class_excess(counts);
+    }
+    for (int i = 0; i < answer.size(); i++)
+    { // Get the index of the bin that has the minimum residual capacity if it encases the item removed out.
+        if (i == index_max_residual)
+        {
+            continue;
+        }
+        if (answer[i].get_cap_left() >= answer[index_max_residual].packed_items.back().get_size() && (constraints == nullptr || constraints->fits(answer[i], answer[index_max_residual].packed_items.back(), -1)))
+        {                                                                                                // If it can be packed.
+            int rest = answer[i].get_cap_left() - answer[index_max_residual].packed_items.back().get_size(); // Get the size after packed.
+            int extra = load_cost.empty() ? 0 : load_cost[get_capacity() - rest] - load_cost[get_capacity() - answer[i].get_cap_left()];
+            if (!load_class.empty() && move_excess(counts, load_out, load_out - answer[index_max_residual].packed_items.back().get_size(), get_capacity() - answer[i].get_cap_left(), get_capacity() - rest) > excess)
+            { // More bins over the limits of the types.
+                continue;
+            }
+            if (extra < minimum_extra || (extra == minimum_extra && rest < minimum_cap))
+            { // Get the minimum index and residual capacity, with bin types the bin whose cost grows the least first.
+                index_min_residual = i;
+                minimum_cap = rest;
+                minimum_extra = extra;
+            }
+        }
+    }
+
+    if ((index_max_residual == -1) || (index_min_residual == -1))
+    { // If no where could be packed, then go to the next neighborhood.
+        return answer;
+    }
+    else
+    {
+        vector<Bin> temp = answer; // The bins are only copied when a move is made.
+        // Move the smallest item from the bin which has max left capacity to the most compact bin that can encase the item.
+        Item item = temp[index_max_residual].remove(temp[index_max_residual].packed_items.size() - 1);
+        temp[index_min_residual].encase(item);
+        if (temp[index_max_residual].packed_items.empty())
+        {
+            temp.erase(temp.begin() + index_max_residual);
+        }
+        return temp;
+    }
+}
+
+/**
+ * This is the second neighborhood of VNS.
+ * This action picks the largest item from the item which has the maximal residual capacity and
+ * tries to change it with another smaller item from other bins by using best fit descent.
+ *
+ * @param answer        vector<Bin> reference type, the used bins of the old solution, left unchanged.
+ * @return              vector<Bin>type, the used bins of the new solution.
+ */
+vector<Bin> Solution::exchange_largest(vector<Bin> &answer)
+{
+    int index_max_residual = -1;
+    int largest;
+    int max_residual = 0;
+    for (int i = 0; i < answer.size(); i++)
+    { // Get the index of the bin with the largest residual capacity.
+        if (answer[i].get_cap_left() > max_residual)
+        {
+            max_residual = answer[i].get_cap_left();
+            index_max_residual = i;
+        }
+    }
+    if (index_max_residual == -1)
+    { // Every bin is full, nothing to exchange.
+        return answer;
+    }
+    largest = answer[index_max_residual].size_counts.front().first; // The largest item in the bin with the largest residual capacity.
+    int index_change = -1;
+    int change_size = -1;
+    int change_position = -1;
+    /**
+     * To find an item smaller then the item in other bin that could be swapped. Items of the same size in a bin give the
+     * same swap, so only the distinct sizes of every bin are tried.
+     */
+    find_exchange(answer, index_max_residual, largest, index_change, change_size, change_position);
+    if (index_change == -1 || change_size == -1)
+    { // If can't find then go to the next neighbourhood.
+        return answer;
+    }
+
+    // Find them successfully and swap them in a copy, the bins are only copied when a move is made.
+    vector<Bin> temp = answer;
+    Item item1 = temp[index_max_residual].remove(temp[index_max_residual].find(largest));
+    Item item2 = temp[index_change].remove(change_position);
+    temp[index_max_residual].encase(item2);
+    temp[index_change].encase(item1);
+    return temp;
+}
+
+/**
+ * This is the third neighborhood of VNS.
+ * This action picks the smallest item from the item which has the maximal residual capacity and tries to
+ * change it with another smaller item from other bins by using best fit descents.
+ *
+ * @param answer        vector<Bin> reference type, the used bins of the old solution, left unchanged.
+ * @return              vector<Bin>type, the used bins of the new solution.
+ */
+vector<Bin> Solution::exchange_smallest(vector<Bin> &answer)
+{
+    int index_max_residual = -1;
+    int smallest;
+    int max_residual = 0;
+    for (int i = 0; i < answer.size(); i++)
+    { // Get the index of the bin with the largest residual capacity.
+        if (answer[i].get_cap_left() > max_residual)
+        {
+            max_residual = answer[i].get_cap_left();
+            index_max_residual = i;
+        }
+    }
+    if (index_max_residual == -1)
+    { // Every bin is full, nothing to exchange.
+        return answer;
+    }
+    smallest = answer[index_max_residual].size_counts.back().first; // The smallest item in the bin with the largest residual capacity.
+    int index_change = -1;
+    int change_size = -1;
+    int change_position = -1;
+    /**
+     * To find an item smaller then the item in other bin that could be swapped. Items of the same size in a bin give the
+     * same swap, so only the distinct sizes of every bin are tried.
+     */
+    find_exchange(answer, index_max_residual, smallest, index_change, change_size, change_position);
+    if (index_change == -1 || change_size == -1)
+    { // If can't find then go to the next neighborhood.
+        return answer;
+    }
+    // Find them successfully and swap them in a copy, the bins are only copied when a move is made.
+    vector<Bin> temp = answer;
+    Item item1 = temp[index_max_residual].remove(temp[index_max_residual].find(smallest));
+    Item item2 = temp[index_change].remove(change_position);
+    temp[index_max_residual].encase(item2);
+    temp[index_change].encase(item1);
+    return temp;
+}
+
+/**
+ * This function is used by the exchange neighborhoods to find the item of another bin to swap with an item of the bin
+ * with the largest residual capacity: the smaller item that leaves the largest residual capacity in that bin, the first
+ * bin in order on a tie. On large instances with a pool, the bins are split into ranges searched by the workers, each
+ * keeps its own best and the bests are reduced at the end, which gives the same move as the sequential search. With side
+ * constraints, the items in conflict are tried one by one and must keep the constraints of both bins. The items without
+ * conflict of a bin all give the same answer, so it is found once for the bin, and when no item has a conflict the
+ * distinct sizes are tried as without constraints. With bin types, the swap whose cheapest types cost the least more comes first, and a swap that puts more
+ * bins over the limits of the types is not made.
+ *
+ * @param answer        vector<Bin> reference type, the bins.
+ * @param index_max_residual int type, the bin with the largest residual capacity.
+ * @param size          int type, the size of the item to swap out of that bin, the last item of the size is swapped.
+ * @param index_change  int reference type, set to the bin of the item to swap in, -1 if there is none.
+ * @param change_size   int reference type, set to the size of the item to swap in, -1 if there is none.
+ * @param change_position int reference type, set to the position of the item to swap in, -1 if there is none.
+ */
+void Solution::find_exchange(vector<Bin> &answer, int index_max_residual, int size, int &index_change, int &change_size, int &change_position)
+{
+    int cap_max = answer[index_max_residual].get_cap_left();
+    int out_position = answer[index_max_residual].find(size);
+    int residual = 0;
+    int extra = INT_MAX;
+    vector<int> counts;
+    long long excess = 0;
+    if (!load_class.empty())
+    { // The bins of every class of types, to keep the limits.
+        counts = count_classes(answer);
+        excess = class_excess(counts);
+    }
+    bool every_free = constraints == nullptr || !constraints->has_conflicts(); // No item to try one by one.
+    mutex best_lock;
+    function<void(int, int)> search = [&](int first, int last)
+    {
+        int local_residual = 0;
+        int local_extra = INT_MAX;
+        int local_change = -1;
+        int local_size = -1;
+        int local_position = -1;
+        vector<int> local_counts = counts; // Changed and restored for every swap tried.
+        for (int i = first; i < last; i++)
+        {
+            if (i == index_max_residual)
+            {
+                continue;
+            }
+            int candidates = every_free ? answer[i].size_counts.size() : answer[i].packed_items.size();
+            int free_fits = -1; // Whether an item without conflict of the bin may swap, -1 until it is needed.
+            for (int k = 0; k < candidates; k++)
+            { // Every distinct size of the bin, or every item when some items are in conflict.
+                int other = every_free ? answer[i].size_counts[k].first : answer[i].packed_items[k].get_size();
+                if ((0 < (cap_max + size - other)) && (cap_max + size - other <= get_capacity()) && ((0 <= answer[i].get_cap_left() - size + other) && (answer[i].get_cap_left() - size + other < get_capacity())) && (size > other))
+                {
+                    int val = cap_max + size - other;
+                    int load_max = get_capacity() - cap_max;
+                    int load_other = get_capacity() - answer[i].get_cap_left();
+                    int price = load_cost.empty() ? 0 : load_cost[load_max - size + other] - load_cost[load_max] + load_cost[load_other + size - other] - load_cost[load_other];
+                    if ((price < local_extra || (price == local_extra && val > local_residual)) && (load_class.empty() || move_excess(local_counts, load_max, load_max - size + other, load_other, load_other + size - other) <= excess))
+                    {
+                        bool free = every_free || !constraints->has_conflicts(answer[i].packed_items[k].getIndex());
+                        if (constraints != nullptr && free && free_fits == -1)
+                        { // Any item without conflict leaves, so no item of the bin is skipped, and the item that joins the
+                          // other bin takes its place there.
+                            free_fits = constraints->fits(answer[i], answer[index_max_residual].packed_items[out_position], answer[i].packed_items.size());
+                        }
+                        if (constraints == nullptr || (free && free_fits == 1) || (!free && constraints->fits(answer[i], answer[index_max_residual].packed_items[out_position], k) && constraints->fits(answer[index_max_residual], answer[i].packed_items[k], out_position)))
+                        {
+                            local_extra = price;
+                            local_residual = val;
+                            local_change = i;
+                            local_size = other;
+                            local_position = every_free ? -1 : k;
+                        }
+                    }
+                }
+            }
+        }
+        lock_guard<mutex> guard(best_lock);
+        if (local_change != -1 && (local_extra < extra || (local_extra == extra && (local_residual > residual || (local_residual == residual && local_change < index_change)))))
+        {
+            extra = local_extra;
+            residual = local_residual;
+            index_change = local_change;
+            change_size = local_size;
+            change_position = local_position;
+        }
+    };
+    index_change = -1;
+    change_size = -1;
+    change_position = -1;
+    if (pool != nullptr && answer.size() >= PARALLEL_BINS)
+    {
+        pool->parallel_for(0, answer.size(), max(1024, (int)answer.size() / (pool->get_num_workers() * 4)), search);
+    }
+    else
+    {
+        search(0, answer.size());
+    }
+    if (index_change != -1 && change_position == -1)
+    { // Any item of the size.
+        change_position = answer[index_change].find(change_size);
+    }
+}
+
+/**
+ * This is the fourth neighborhood of the VNS.
+ * This function is to randomly select half items from a bin that exceeds the average items per bin to a new bin.
+ *
+ * @param answer        vector<Bin> reference type, the used bins of the old solution, left unchanged.
+ * @return              vector<Bin>type, the used bins of the new solution.
+ */
+vector<Bin> Solution::split(vector<Bin> &answer)
+{
+    vector<Bin> temp = answer;
+    float total_items = 0.0;
+    float average_items;
+    for (int i = 0; i < temp.size(); i++)
+    {
+        total_items += (float)temp[i].packed_items.size();
+        ;
+    }
+    average_items = total_items / (float)temp.size(); // To get the average items of per items in all bins.
+    vector<int> vec;
+    for (int i = 0; i < temp.size(); i++)
+    {
+        if (temp[i].packed_items.size() > average_items)
+        {
+            vec.push_back(i);
+        }
+    }
+    if (vec.empty())
+    { // Every bin has the same number of items.
+        return answer;
+    }
+    int random_select = rng() % vec.size();
+    int times = temp[vec[random_select]].packed_items.size() * split_ratio;
+    Bin bin(get_capacity()); // Move a part of the items, half by default, from a random bin to a new bin.
+    for (int i = 0; i < times; i++)
+    {
+        int index_item = rng() % temp[vec[random_select]].packed_items.size();
+        bin.encase(temp[vec[random_select]].remove(index_item));
+    }
+    temp.push_back(bin);
+    return temp;
+}
+
+/**
+ * This is the shaking procedure of VNS.
+ * This action picks randomly two items from different bins and swap them. The items are picked by size among the
+ * distinct sizes of each bin, and two items of the same size are never swapped as that changes nothing.
+ *
+ * @param answer        vector<Bin> reference type, the used bins of the old solution, left unchanged.
+ * @return              vector<Bin>type, the used bins of the new solution.
+ */
+vector<Bin> Solution::shaking(vector<Bin> &answer)
+{
+    vector<Bin> temp = answer;
+    int random_select_bin1;
+    int random_select_bin2;
+    int a, b, c, d;
+    bool judge;
+    chrono::steady_clock::time_point startTime, endTime;
+    startTime = chrono::steady_clock::now();
+    do
+    {
+        random_select_bin1 = rng() % temp.size(); // Randomly get the bins and sizes.
+        random_select_bin2 = rng() % temp.size();
+        a = temp[random_select_bin1].get_cap_left();
+        b = temp[random_select_bin2].get_cap_left();
+        c = temp[random_select_bin1].size_counts[rng() % temp[random_select_bin1].size_counts.size()].first;
+        d = temp[random_select_bin2].size_counts[rng() % temp[random_select_bin2].size_counts.size()].first;
+        judge = ((0 <= a + c - d) && (a + c - d <= get_capacity()) && (0 <= b - c + d) && (b - c + d) <= get_capacity() && (a != 0) && (b != 0) && (a != b) && (c != d));
+        if (judge && constraints != nullptr)
+        { // The two items must keep the side constraints of the bins they go to.
+            int position1 = temp[random_select_bin1].find(c);
+            int position2 = temp[random_select_bin2].find(d);
+            judge = constraints->fits(temp[random_select_bin2], temp[random_select_bin1].packed_items[position1], position2) && constraints->fits(temp[random_select_bin1], temp[random_select_bin2].packed_items[position2], position1);
+        }
+        endTime = chrono::steady_clock::now();
+        if ((chrono::duration<double>(endTime - startTime).count() >= shake_timeout) && !judge)
+        {
+            return answer;
+        }
+    } while (!judge); // Find two items from different bins then do next.
+    Item item1 = temp[random_select_bin1].remove(temp[random_select_bin1].find(c));
+    Item item2 = temp[random_select_bin2].remove(temp[random_select_bin2].find(d));
+    temp[random_select_bin1].encase(item2);
+    temp[random_select_bin2].encase(item1);
+    return temp;
+}
+
+/**
+ * This function is used to calculate the current number of used bins and the abs_gap.
+ *
+ * @param objective     int type, the number of the current used bins.
+ */
+void Solution::set_objective(int objective)
+{
+    this->objective = objective;
+    this->abs_gap = objective - best_known;
+}
+
+/**
+ * This function is used to get the current number of used bins.
+ *
+ * @return              int type, the number of the current used bins.
+ */
+const float Solution::get_objective()
+{
+    return objective;
+}
+/**
+ * This function is used to get the capacity of the solution.
+ *
+ * @return              int type, the capacity of the solution.
+ */
+const int Solution::get_capacity()
+{
+    return capacity;
+}
+
+/**
+ * This function is used to get the current bins of the solution.
+ *
+ * @return              vector<Bin> type, the current bins of the solution.
+ */
+vector<Bin> Solution::get_bins()
+{
+    return bins;
+}
+
+/**
+ * This function is used to get the identifier of the current solution.
+ *
+ * @return              string type, the identifier of the instance.
+ */
+const string Solution::get_identifier()
+{
+    return identifier;
+}
+
+/**
+ * This function is used to get the abs_gap of the instance.
+ *
+ * @return              float type, the abs_gap of the instance
+ */
+const float Solution::get_abs_gap()
+{
+    return abs_gap;
+}
+
+/**
+ * This function is used to set the currently used bins of the instance.
+ *
+ * @param bins         vector<Bin> type, the currently used bins of the instance.
+ */
+void Solution::set_bins(vector<Bin> bins)
+{
+    this->bins = bins;
+}
+
+/**
+ * This function is used to set the flag that VNS checks in every iteration. Once the flag is raised, VNS stops and
+ * returns the best bins found so far.
+ *
+ * @param cancel        const atomic<bool> pointer type, the cancel flag, or nullptr to run until the time limit.
+ */
+void Solution::set_cancel(const atomic<bool> *cancel)
+{
+    this->cancel = cancel;
+}
+
+/**
+ * This function is used to bound VNS by the number of neighborhood moves besides the time limit.
+ *
+ * @param move_limit    int type, the maximum neighborhood moves, 0 means no limit.
+ */
+void Solution::set_move_limit(int move_limit)
+{
+    this->move_limit = move_limit;
+}
+
+/**
+ * This function is used to set how long the shaking procedure looks for two items to swap before it gives up.
+ *
+ * @param shake_timeout double type, the time in seconds.
+ */
+void Solution::set_shake_timeout(double shake_timeout)
+{
+    this->shake_timeout = shake_timeout;
+}
+
+/**
+ * This function is used to set the seed of the random choices made by split and shaking, so that a run can be repeated.
+ *
+ * @param seed          unsigned type, the seed.
+ */
+void Solution::set_seed(unsigned seed)
+{
+    rng.seed(seed);
+}
+
+/**
+ * This function is used to set how many neighborhoods VNS uses, in the order shift, exchange_largest, exchange_smallest
+ * and split.
+ *
+ * @param neighborhood  int type, the number of neighborhoods from 1 to 4.
+ */
+void Solution::set_neighborhood(int neighborhood)
+{
+    this->neighborhood = max(1, min(4, neighborhood));
+}
+
+/**
+ * This function is used to set the settings of the search used by VNS: the neighborhoods, the shaking timeout and the
+ * part of a bin moved by split.
+ *
+ * @param config        const SearchConfig reference type, the settings.
+ */
+void Solution::set_config(const SearchConfig &config)
+{
+    set_neighborhood(config.neighborhood);
+    shake_timeout = config.shake_timeout;
+    split_ratio = max(0.0, min(1.0, config.split_ratio));
+}
+
+/**
+ * This function is used to set where VNS reports every new best number of bins.
+ *
+ * @param progress      Progress pointer type, the report, or nullptr for none.
+ */
+void Solution::set_progress(Progress *progress)
+{
+    this->progress = progress;
+}
+
+/**
+ * This function is used to set the workers that search the exchange neighborhoods of instances with at least
+ * PARALLEL_BINS bins.
+ *
+ * @param pool          WorkStealingPool pointer type, the workers, or nullptr to search in the calling thread only.
+ */
+void Solution::set_pool(WorkStealingPool *pool)
+{
+    this->pool = pool;
+}
+
+/**
+ * This function is used to set the side constraints of the instance. The initial solution, every neighborhood and
+ * shaking only make moves that keep them.
+ *
+ * @param constraints   Constraints pointer type, the side constraints, or nullptr if there are none.
+ */
+void Solution::set_constraints(Constraints *constraints)
+{
+    this->constraints = constraints;
+}
+
+/**
+ * This function is used to set the number of bins at which VNS stops, as no solution can have fewer.
+ *
+ * @param target        int type, the number of bins, 0 to search until the time limit.
+ */
+void Solution::set_target(int target)
+{
+    this->target = target;
+}
+
+/**
+ * This function is used to get the initial solution of a large instance with side constraints by best fit decreasing.
+ * The open bins are kept by residual capacity, and every item goes to the bin with the least room left that holds it and
+ * keeps the constraints, or to a new bin. The bins of the items already packed that are in conflict with the item are
+ * marked first, so the bins passed over are at most its conflicts and no bin is checked item by item. A bin with the
+ * maximum number of items is no longer open.
+ *
+ * @param problem       Problem reference type, the instance.
+ */
+void Solution::initialize_constrained(Problem &problem)
+{
+    vector<Bin> packed;
+    multiset<pair<int, int>> room; // The residual capacity of every open bin, and the bin.
+    vector<int> bin_of(problem.get_next_index(), -1);
+    vector<int> marked; // The last item whose conflicts are in every bin.
+    for (int i = 0; i < problem.items.size(); i++)
+    {
+        vector<int> partners = constraints->neighbors(problem.items[i].getIndex());
+        for (int k = 0; k < partners.size(); k++)
+        {
+            if (partners[k] < bin_of.size() && bin_of[partners[k]] != -1)
+            {
+                marked[bin_of[partners[k]]] = i;
+            }
+        }
+        multiset<pair<int, int>>::iterator fit = room.lower_bound(make_pair(problem.items[i].get_size(), -1));
+        while (fit != room.end() && marked[fit->second] == i)
+        {
+            fit++;
+        }
+        int chosen;
+        if (fit == room.end())
+        {
+            chosen = packed.size();
+            packed.push_back(Bin(capacity));
+            marked.push_back(-1);
+        }
+        else
+        {
+            chosen = fit->second;
+            room.erase(fit);
+        }
+        packed[chosen].encase(problem.items[i]);
+        bin_of[problem.items[i].getIndex()] = chosen;
+        if (constraints->get_max_items() == 0 || packed[chosen].packed_items.size() < constraints->get_max_items())
+        { // A bin with the maximum number of items takes no more.
+            room.insert(make_pair(packed[chosen].get_cap_left(), chosen));
+        }
+    }
+    bins = packed;
+    set_objective(bins.size());
+}
+
+/**
+ * This function is used to pack onto several bin types instead of bins of the capacity of the instance. The search keeps
+ * bins of the largest capacity, which must be the capacity of the instance, and prices every bin by the cheapest type that
+ * holds its load, so that the cost of a bin is found in O(1). The best known solution becomes the lower bound of the cost
+ * that packs every size unit at the lowest cost per unit.
+ *
+ * With limits, the types of the same capacity make a class, and a bin can take the types of the smallest class that holds
+ * its load or of any larger class. So the bins can be given types within the limits if and only if, from every class, the
+ * bins of that class and of the larger ones are no more than the types of these classes allow. The class of every load is
+ * kept in a table, so that the search counts the bins of every class as it counts their cost.
+ *
+ * @param bin_types     vector<BinType> type, the bin types.
+ * @param problem       Problem reference type, the instance.
+ */
+void Solution::set_bin_types(vector<BinType> bin_types, Problem &problem)
+{
+    this->bin_types = bin_types;
+    load_cost.assign(capacity + 1, INT_MAX);
+    load_cost[0] = 0;
+    double unit_cost = INT_MAX;
+    for (int t = 0; t < bin_types.size(); t++)
+    {
+        for (int load = 1; load <= min(capacity, bin_types[t].capacity); load++)
+        {
+            load_cost[load] = min(load_cost[load], bin_types[t].cost);
+        }
+        unit_cost = min(unit_cost, (double)bin_types[t].cost / bin_types[t].capacity);
+    }
+    load_class.clear();
+    class_room.clear();
+    vector<int> capacities;
+    bool limited = false;
+    for (int t = 0; t < bin_types.size(); t++)
+    {
+        capacities.push_back(min(capacity, bin_types[t].capacity));
+        limited = limited || bin_types[t].limit > 0;
+    }
+    if (limited)
+    {
+        sort(capacities.begin(), capacities.end());
+        capacities.erase(unique(capacities.begin(), capacities.end()), capacities.end());
+        load_class.assign(capacity + 1, -1);
+        for (int load = 1, c = 0; load <= capacity; load++)
+        {
+            while (capacities[c] < load)
+            {
+                c++;
+            }
+            load_class[load] = c;
+        }
+        class_room.assign(capacities.size(), 0);
+        for (int t = 0; t < bin_types.size(); t++)
+        {
+            int c = lower_bound(capacities.begin(), capacities.end(), min(capacity, bin_types[t].capacity)) - capacities.begin();
+            class_room[c] = bin_types[t].limit == 0 || class_room[c] == LLONG_MAX ? LLONG_MAX : class_room[c] + bin_types[t].limit;
+        }
+        for (int c = capacities.size() - 2; c >= 0; c--)
+        { // The bins of a class may take the types of the larger classes as well.
+            class_room[c] = class_room[c] == LLONG_MAX || class_room[c + 1] == LLONG_MAX ? LLONG_MAX : class_room[c] + class_room[c + 1];
+        }
+    }
+    long long total = 0;
+    for (int i = 0; i < problem.items.size(); i++)
+    {
+        total += problem.items[i].get_size();
+    }
+    best_known = ceil(total * unit_cost - 1e-9);
+}
+
+/**
+ * This function is used to get the initial solution with bin types by best fit decreasing. Every item goes to the open
+ * bin with the least room left that holds it, and when there is none, a bin is opened of the type with the lowest cost per
+ * unit of capacity among the types that hold the item and still have bins left, the larger on a tie. Tight limits on the
+ * large types are better kept by opening the smallest type that holds the item instead, the cheaper on a tie, so that the
+ * large types are left to be shared by the items that come next. When the limits
+ * leave no such type, an open bin that a larger type with bins left would hold with the item is given that type instead.
+ * Only if there is none either, a bin of the largest type is opened over its limit, for the search to bring back. The
+ * type only bounds the load of the bin here, the bins keep the capacity of the instance for the search.
+ *
+ * @param problem       Problem reference type, the instance.
+ * @param tight         bool type, open the smallest type that holds the item instead of the cheapest per unit.
+ */
+void Solution::initialize_types(Problem &problem, bool tight)
+{
+    vector<Bin> packed;
+    vector<int> used(bin_types.size(), 0);
+    vector<int> type_of;            // The type of every open bin.
+    multiset<pair<int, int>> room; // The room left by the type of every open bin, and the bin.
+    int largest = 0;
+    for (int t = 0; t < bin_types.size(); t++)
+    {
+        if (bin_types[t].capacity > bin_types[largest].capacity)
+        {
+            largest = t;
+        }
+    }
+    auto available = [&](int t)
+    { return bin_types[t].limit == 0 || used[t] < bin_types[t].limit; };
+    for (int i = 0; i < problem.items.size(); i++)
+    {
+        int size = problem.items[i].get_size();
+        int chosen = -1;
+        multiset<pair<int, int>>::iterator fit = room.lower_bound(make_pair(size, -1));
+        if (fit != room.end())
+        {
+            chosen = fit->second;
+            int left = fit->first - size;
+            room.erase(fit);
+            room.insert(make_pair(left, chosen));
+        }
+        else
+        {
+            int type = -1;
+            for (int t = 0; t < bin_types.size(); t++)
+            {
+                if (bin_types[t].capacity < size || !available(t))
+                {
+                    continue;
+                }
+                if (tight)
+                {
+                    if (type == -1 || bin_types[t].capacity < bin_types[type].capacity || (bin_types[t].capacity == bin_types[type].capacity && bin_types[t].cost < bin_types[type].cost))
+                    {
+                        type = t;
+                    }
+                    continue;
+                }
+                long long unit = (long long)bin_types[t].cost * (type == -1 ? 1 : bin_types[type].capacity);
+                long long best = (long long)(type == -1 ? 0 : bin_types[type].cost) * bin_types[t].capacity;
+                if (type == -1 || unit < best || (unit == best && bin_types[t].capacity > bin_types[type].capacity))
+                {
+                    type = t;
+                }
+            }
+            if (type == -1)
+            { // The limits are reached, give an open bin a larger type that holds the item as well.
+                int least = INT_MAX;
+                for (int b = 0; b < packed.size(); b++)
+                {
+                    int load = packed[b].get_capacity() - packed[b].get_cap_left() + size;
+                    for (int t = 0; t < bin_types.size(); t++)
+                    {
+                        if (bin_types[t].capacity >= load && available(t) && bin_types[t].capacity - load < least)
+                        {
+                            least = bin_types[t].capacity - load;
+                            chosen = b;
+                            type = t;
+                        }
+                    }
+                }
+                if (chosen != -1)
+                {
+                    room.erase(room.find(make_pair(bin_types[type_of[chosen]].capacity - (packed[chosen].get_capacity() - packed[chosen].get_cap_left()), chosen)));
+                    room.insert(make_pair(least, chosen));
+                    used[type_of[chosen]]--;
+                    used[type]++;
+                    type_of[chosen] = type;
+                }
+            }
+            if (chosen == -1)
+            { // No type is left that holds the item, the largest one is used over its limit.
+                type = type == -1 ? largest : type;
+                used[type]++;
+                chosen = packed.size();
+                packed.push_back(Bin(capacity));
+                type_of.push_back(type);
+                room.insert(make_pair(bin_types[type].capacity - size, chosen));
+            }
+        }
+        packed[chosen].encase(problem.items[i]);
+    }
+    bins = packed;
+    set_objective(bins.size());
+}
+
+/**
+ * This function is used to get the total cost of the bins: the cost of its bin type for a bin that has one, otherwise the
+ * cost of the cheapest type that holds its load.
+ *
+ * @param bins          vector<Bin> reference type, the bins.
+ * @return              long long type, the total cost.
+ */
+long long Solution::get_cost(vector<Bin> &bins)
+{
+    long long cost = 0;
+    for (int i = 0; i < bins.size(); i++)
+    {
+        if (bins[i].get_type() >= 0)
+        {
+            cost += bin_types[bins[i].get_type()].cost;
+        }
+        else
+        {
+            cost += load_cost[bins[i].get_capacity() - bins[i].get_cap_left()];
+        }
+    }
+    return cost;
+}
+
+/**
+ * This function is used to count a load in its class of bin types, an empty bin has no class.
+ *
+ * @param counts        vector<int> reference type, the bins of every class.
+ * @param load          int type, the load of the bin.
+ * @param change        int type, 1 to count the bin, -1 to take it out.
+ */
+void Solution::count_load(vector<int> &counts, int load, int change)
+{
+    if (load > 0)
+    {
+        counts[load_class[load]] += change;
+    }
+}
+
+/**
+ * This function is used to count the bins of every class of bin types.
+ *
+ * @param bins          vector<Bin> reference type, the bins.
+ * @return              vector<int> type, the bins of every class.
+ */
+vector<int> Solution::count_classes(vector<Bin> &bins)
+{
+    vector<int> counts(class_room.size(), 0);
+    for (int i = 0; i < bins.size(); i++)
+    {
+        count_load(counts, bins[i].get_capacity() - bins[i].get_cap_left(), 1);
+    }
+    return counts;
+}
+
+/**
+ * This function is used to get how many bins are over the limits of the bin types from the bins of every class: from
+ * every class, the bins of that class and of the larger ones that the types of these classes do not allow, summed.
+ *
+ * @param counts        vector<int> reference type, the bins of every class.
+ * @return              long long type, 0 if the bins can be given types within the limits.
+ */
+long long Solution::class_excess(vector<int> &counts)
+{
+    long long excess = 0;
+    long long need = 0;
+    for (int c = counts.size() - 1; c >= 0; c--)
+    {
+        need += counts[c];
+        if (class_room[c] != LLONG_MAX && need > class_room[c])
+        {
+            excess += need - class_room[c];
+        }
+    }
+    return excess;
+}
+
+/**
+ * This function is used to get how many bins would be over the limits of the bin types if two bins changed their loads,
+ * in O(classes) from the bins of every class, which are left as they were.
+ *
+ * @param counts        vector<int> reference type, the bins of every class.
+ * @param old_a         int type, the load of the first bin.
+ * @param new_a         int type, the new load of the first bin.
+ * @param old_b         int type, the load of the second bin.
+ * @param new_b         int type, the new load of the second bin.
+ * @return              long long type, the bins over the limits after the change.
+ */
+long long Solution::move_excess(vector<int> &counts, int old_a, int new_a, int old_b, int new_b)
+{
+    count_load(counts, old_a, -1);
+    count_load(counts, new_a, 1);
+    count_load(counts, old_b, -1);
+    count_load(counts, new_b, 1);
+    long long excess = class_excess(counts);
+    count_load(counts, new_b, -1);
+    count_load(counts, old_b, 1);
+    count_load(counts, new_a, -1);
+    count_load(counts, old_a, 1);
+    return excess;
+}
+
+/**
+ * This function is used to get how many bins are over the limits of the bin types, 0 without limits.
+ *
+ * @param bins          vector<Bin> reference type, the bins.
+ * @return              long long type, 0 if the bins can be given types within the limits.
+ */
+long long Solution::get_excess(vector<Bin> &bins)
+{
+    if (load_class.empty())
+    {
+        return 0;
+    }
+    vector<int> counts = count_classes(bins);
+    return class_excess(counts);
+}
+
+/**
+ * This function is used to know whether the bin types given by the last call of assign_types are within the limits.
+ *
+ * @return              bool type, true if they are, or if no types have been given.
+ */
+const bool Solution::is_within_limits()
+{
+    return within_limits;
+}
+
+/**
+ * This function is used to give every bin a bin type when the search is over. From the fullest bin, every bin takes the
+ * cheapest type that holds its load and still has bins left, the smallest capacity on a tie. As the bins left are never
+ * fuller, any type taken would have held them too, so this keeps the limits whenever get_excess is 0. If the limits leave
+ * no type for a bin, it takes the cheapest type that holds it anyway.
+ *
+ * @param bins          vector<Bin> reference type, the bins, their types and capacities are set.
+ * @return              bool type, false if the limits of the bin types have been exceeded.
+ */
+bool Solution::assign_types(vector<Bin> &bins)
+{
+    vector<int> order(bins.size());
+    vector<int> used(bin_types.size(), 0);
+    bool within = true;
+    for (int i = 0; i < bins.size(); i++)
+    {
+        order[i] = i;
+    }
+    sort(order.begin(), order.end(), [&bins](int a, int b)
+         { return bins[a].get_capacity() - bins[a].get_cap_left() > bins[b].get_capacity() - bins[b].get_cap_left(); });
+    for (int i = 0; i < order.size(); i++)
+    {
+        Bin &bin = bins[order[i]];
+        int load = bin.get_capacity() - bin.get_cap_left();
+        int chosen = -1;
+        int fallback = -1;
+        for (int t = 0; t < bin_types.size(); t++)
+        {
+            if (bin_types[t].capacity < load)
+            {
+                continue;
+            }
+            auto cheaper = [&](int other)
+            { return other == -1 || bin_types[t].cost < bin_types[other].cost || (bin_types[t].cost == bin_types[other].cost && bin_types[t].capacity < bin_types[other].capacity); };
+            if (cheaper(fallback))
+            {
+                fallback = t;
+            }
+            if ((bin_types[t].limit == 0 || used[t] < bin_types[t].limit) && cheaper(chosen))
+            {
+                chosen = t;
+            }
+        }
+        if (chosen == -1)
+        {
+            chosen = fallback;
+            within = false;
+        }
+        used[chosen]++;
+        bin.set_type(chosen, bin_types[chosen].capacity);
+    }
+    within_limits = within;
+    return within;
+}
+
+/**
+ * This function is used to read the bin types of the variable-sized bin packing from a list "capacity:cost:limit,...",
+ * where the limit may be left out for no limit.
+ *
+ * @param list          string type, the list.
+ * @param bin_types     vector<BinType> reference type, set to the bin types.
+ * @return              bool type, false if the list is not valid.
+ */
+bool parse_bin_types(string list, vector<BinType> &bin_types)
+{
+    istringstream types(list);
+    string type;
+    bin_types.clear();
+    while (getline(types, type, ','))
+    {
+        BinType bin_type = {0, -1, 0};
+        if (sscanf(type.c_str(), "%d:%d:%d", &bin_type.capacity, &bin_type.cost, &bin_type.limit) < 2 || bin_type.capacity <= 0 || bin_type.cost < 0 || bin_type.limit < 0)
+        {
+            return false;
+        }
+        bin_types.push_back(bin_type);
+    }
+    return !bin_types.empty();
+}
+
+/**
+ * This function is used to replace the capacity of an instance by the largest capacity of the bin types.
+ *
+ * @param problem       Problem reference type, the instance.
+ * @param bin_types     vector<BinType> reference type, the bin types.
+ * @return              bool type, false if an item does not fit in any bin type.
+ */
+bool fit_bin_types(Problem &problem, vector<BinType> &bin_types)
+{
+    int largest = 0;
+    for (int t = 0; t < bin_types.size(); t++)
+    {
+        largest = max(largest, bin_types[t].capacity);
+    }
+    problem.set_capacity(largest);
+    return problem.items.empty() || problem.items[0].get_size() <= largest;
+}
+
+/**
+ * This function is used to regulate the left residual crack according to the capacity of the bins when using relaxed mbs.
+ *
+ * @param num           int type, the number of items in the instance.
+ * @param config        const SearchConfig reference type, the settings of the search that hold the cracks.
+ * @return              int type, the allowable slack.
+ */
+int factor(int num, const SearchConfig &config)
+{
+    int temp;
+    if (num == 120)
+    {
+        temp = config.crack_120;
+    }
+    else if (num == 500)
+    {
+        temp = config.crack_500;
+    }
+    else
+    {
+        temp = config.crack_other;
+    }
+    return temp;
+}
+
+/**
+ * This function is used to read a solution file written by this program. Every instance is recognised by its identifier
+ * line which is followed by the "obj=" line, and all the following lines up to the next instance are its bins.
+ *
+ * @param inFile        istream reference type, the solution file.
+ * @return              map<string, vector<vector<int>>> type, the item indexes of every bin by the instance identifier.
+ */
+map<string, vector<vector<int>>> read_solutions(istream &inFile)
+{
+    map<string, vector<vector<int>>> packings;
+    vector<string> lines;
+    string str;
+    getline(inFile, str); // The number of instances.
+    while (getline(inFile, str))
+    {
+        if (!str.empty() && str.back() == '\r')
+        {
+            str.pop_back();
+        }
+        lines.push_back(str);
+    }
+    vector<vector<int>> *packing = nullptr;
+    for (int i = 0; i < lines.size(); i++)
+    {
+        if (i + 1 < lines.size() && lines[i + 1].compare(0, 4, "obj=") == 0)
+        { // The identifier of the next instance.
+            packing = &packings[lines[i]];
+            packing->clear();
+            i++;
+            continue;
+        }
+        if (packing == nullptr || lines[i].find_first_not_of(" \t") == string::npos || lines[i].compare(0, 6, "types=") == 0)
+        { // The bin types are not part of the packing.
+            continue;
+        }
+        istringstream bin(lines[i]);
+        vector<int> indexes;
+        int index;
+        while (bin >> index)
+        {
+            indexes.push_back(index);
+        }
+        packing->push_back(indexes);
+    }
+    return packings;
+}
+
+/**
+ * This function is used to read the identifiers of the instances a checkpoint has finished: its first line gives the
+ * number of solutions and then the number of finished ones, which are the first solutions of the file.
+ *
+ * @param inFile        istream reference type, the checkpoint file.
+ * @return              set<string> type, the identifiers of the finished instances.
+ */
+set<string> read_finished(istream &inFile)
+{
+    set<string> finished;
+    string str;
+    getline(inFile, str);
+    int count = 0;
+    int done = 0;
+    istringstream(str) >> count >> done;
+    string identifier;
+    while (finished.size() < done && getline(inFile, str))
+    {
+        if (!str.empty() && str.back() == '\r')
+        {
+            str.pop_back();
+        }
+        if (str.compare(0, 4, "obj=") == 0)
+        { // The line before it is the identifier.
+            finished.insert(identifier);
+        }
+        identifier = str;
+    }
+    return finished;
+}
+
+/**
+ * This class is one island of the island model: several processes solve the same data file at the same time with their
+ * own seeds, and every migration interval each of them sends its best packing of the instance to its neighbours and takes
+ * the best packing received if it is better than its own. A packing travels as the bin of every item index, in 2 bytes
+ * per item when there are fewer than 65535 bins and in 4 bytes otherwise, the items fixed by the reductions have no bin.
+ * An address is the path of a Unix domain socket for the islands on the same host, or host:port for TCP between hosts.
+ */
+class Island
+{
+public:
+    Island(vector<string>, int, bool, double);   // Constructor of Island.
+    ~Island();                                   // Destructor of Island, stop listening.
+    bool open();                                 // Start listening on the own address.
+    const double get_interval();                 // Get the time between two migrations.
+    void migrate(string, vector<Bin> &);         // Send a packing to the neighbours.
+    bool receive(string, vector<vector<int>> &); // Take the best packing received for an instance.
+private:
+    int open_socket(string, bool);               // Bind or connect a socket to an address.
+    void collect();                              // Accept the migrants until stopped.
+    void accept_migrant(int);                    // Read a migrant from a connection.
+    vector<string> peers;
+    int self;
+    bool complete;
+    double interval;
+    int listener;
+    thread collector;
+    atomic<bool> stopping;
+    map<string, vector<vector<int>>> inbox; // The best packing received for every instance.
+    mutex inbox_lock;
+};
+
+/**
+ * This function is the constructor of Island.
+ *
+ * @param peers         vector<string> type, the addresses of all the islands, the same list for every island.
+ * @param self          int type, the position of this island in the list.
+ * @param complete      bool type, send to every other island if true, otherwise only to the next one of the ring.
+ * @param interval      double type, the time between two migrations in seconds.
+ */
+Island::Island(vector<string> peers, int self, bool complete, double interval)
+{
+    this->peers = peers;
+    this->self = self;
+    this->complete = complete;
+    this->interval = interval;
+    this->listener = -1;
+    this->stopping = false;
+}
+
+/**
+ * This function is the destructor of Island, it stops listening and removes its Unix domain socket.
+ */
+Island::~Island()
+{
+    stopping = true;
+    if (collector.joinable())
+    {
+        collector.join();
+    }
+    if (listener >= 0)
+    {
+        close(listener);
+        if (peers[self].find(':') == string::npos)
+        {
+            unlink(peers[self].c_str());
+        }
+    }
+}
+
+/**
+ * This function is used to get the time between two migrations.
+ *
+ * @return              double type, the migration interval in seconds.
+ */
+const double Island::get_interval()
+{
+    return interval;
+}
+
+/**
+ * This function is used to open a stream socket on an address, a Unix domain socket path or host:port. The socket gives
+ * up after a second on a neighbour that does not answer, so a slow island never holds up the search of another.
+ *
+ * @param address       string type, the address.
+ * @param listening     bool type, bind the socket to the address if true, otherwise connect it.
+ * @return              int type, the socket, -1 if the address can not be used.
+ */
+int Island::open_socket(string address, bool listening)
+{
+    timeval timeout = {1, 0};
+    size_t colon = address.rfind(':');
+    vector<pair<sockaddr_storage, socklen_t>> targets;
+    if (colon == string::npos)
+    { // A Unix domain socket on this host.
+        sockaddr_un unix_address;
+        memset(&unix_address, 0, sizeof(unix_address));
+        unix_address.sun_family = AF_UNIX;
+        if (address.length() >= sizeof(unix_address.sun_path))
+        {
+            return -1;
+        }
+        strcpy(unix_address.sun_path, address.c_str());
+        if (listening)
+        {
+            unlink(address.c_str()); // Remove the socket left by a previous run.
+        }
+        sockaddr_storage target;
+        memcpy(&target, &unix_address, sizeof(unix_address));
+        targets.push_back(make_pair(target, (socklen_t)sizeof(unix_address)));
+    }
+    else
+    { // A TCP address, the host may have several.
+        addrinfo hints;
+        addrinfo *found = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = listening ? AI_PASSIVE : 0;
+        string host = address.substr(0, colon);
+        if (getaddrinfo(host.empty() ? nullptr : host.c_str(), address.substr(colon + 1).c_str(), &hints, &found) != 0)
+        {
+            return -1;
+        }
+        for (addrinfo *it = found; it != nullptr; it = it->ai_next)
+        {
+            sockaddr_storage target;
+            memcpy(&target, it->ai_addr, it->ai_addrlen);
+            targets.push_back(make_pair(target, it->ai_addrlen));
+        }
+        freeaddrinfo(found);
+    }
+    for (int i = 0; i < targets.size(); i++)
+    {
+        int fd = socket(targets[i].first.ss_family, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            continue;
+        }
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr *target = (sockaddr *)&targets[i].first;
+        if ((listening ? bind(fd, target, targets[i].second) : connect(fd, target, targets[i].second)) == 0)
+        {
+            return fd;
+        }
+        close(fd);
+    }
+    return -1;
+}
+
+/**
+ * This function is used to listen on the own address and start collecting the migrants of the neighbours.
+ *
+ * @return              bool type, false if the address can not be used.
+ */
+bool Island::open()
+{
+    listener = open_socket(peers[self], true);
+    if (listener < 0 || listen(listener, SOMAXCONN) < 0)
+    {
+        return false;
+    }
+    collector = thread(&Island::collect, this);
+    return true;
+}
+
+/**
+ * This function is the loop of the collector. It accepts the connections of the neighbours, each brings one migrant.
+ */
+void Island::collect()
+{
+    while (!stopping)
+    {
+        pollfd fd = {listener, POLLIN, 0};
+        if (poll(&fd, 1, 100) <= 0)
+        {
+            continue;
+        }
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            continue;
+        }
+        timeval timeout = {1, 0};
+        setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        accept_migrant(connection);
+        close(connection);
+    }
+}
+
+/**
+ * This function is used to read a migrant: the identifier line, a line with the number of item indexes and the bytes per
+ * index, then the bin of every item index in network byte order, all ones for an item without bin. The packing is kept if
+ * it has no more bins than the one already received for the instance.
+ *
+ * @param connection    int type, the connection of a neighbour, closed by the neighbour after the migrant.
+ */
+void Island::accept_migrant(int connection)
+{
+    string data;
+    char chunk[65536];
+    int num;
+    while ((num = recv(connection, chunk, sizeof(chunk), 0)) > 0)
+    {
+        data.append(chunk, num);
+    }
+    size_t first = data.find('\n');
+    size_t second = data.find('\n', first + 1);
+    if (first == string::npos || second == string::npos)
+    {
+        return;
+    }
+    string identifier = data.substr(0, first);
+    long length = -1;
+    int width = 0;
+    istringstream(data.substr(first + 1, second - first - 1)) >> length >> width;
+    if ((width != 2 && width != 4) || length < 0 || data.size() - second - 1 != length * width)
+    { // Broken or cut off.
+        return;
+    }
+    const char *payload = data.data() + second + 1;
+    vector<vector<int>> packing;
+    for (int i = 0; i < length; i++)
+    {
+        uint32_t bin;
+        if (width == 2)
+        {
+            uint16_t value;
+            memcpy(&value, payload + 2 * i, 2);
+            value = ntohs(value);
+            bin = value == 0xFFFF ? UINT32_MAX : value;
+        }
+        else
+        {
+            memcpy(&bin, payload + 4 * i, 4);
+            bin = ntohl(bin);
+        }
+        if (bin == UINT32_MAX)
+        {
+            continue;
+        }
+        if (bin >= length)
+        { // More bins than items.
+            return;
+        }
+        if (bin >= packing.size())
+        {
+            packing.resize(bin + 1);
+        }
+        packing[bin].push_back(i);
+    }
+    lock_guard<mutex> guard(inbox_lock);
+    map<string, vector<vector<int>>>::iterator kept = inbox.find(identifier);
+    if (kept == inbox.end() || kept->second.size() >= packing.size())
+    {
+        inbox[identifier] = packing;
+    }
+}
+
+/**
+ * This function is used to send the bins of an instance to the neighbours: the next island of the ring, or every other
+ * island in the complete topology. A neighbour that can not be reached is skipped, it may not have started yet or may
+ * have finished already.
+ *
+ * @param identifier    string type, the identifier of the instance.
+ * @param bins          vector<Bin> reference type, the bins to send.
+ */
+void Island::migrate(string identifier, vector<Bin> &bins)
+{
+    int length = 0;
+    int width = bins.size() < 0xFFFF ? 2 : 4;
+    for (int i = 0; i < bins.size(); i++)
+    {
+        for (int k = 0; k < bins[i].packed_items.size(); k++)
+        {
+            length = max(length, bins[i].packed_items[k].getIndex() + 1);
+        }
+    }
+    string message = identifier + "\n" + to_string(length) + " " + to_string(width) + "\n";
+    size_t header = message.size();
+    message.resize(header + (size_t)length * width, '\xff'); // All ones for the items without bin.
+    for (int i = 0; i < bins.size(); i++)
+    {
+        for (int k = 0; k < bins[i].packed_items.size(); k++)
+        {
+            size_t offset = header + (size_t)bins[i].packed_items[k].getIndex() * width;
+            if (width == 2)
+            {
+                uint16_t value = htons(i);
+                memcpy(&message[offset], &value, 2);
+            }
+            else
+            {
+                uint32_t value = htonl(i);
+                memcpy(&message[offset], &value, 4);
+            }
+        }
+    }
+    for (int i = 0; i < peers.size(); i++)
+    {
+        if (i == self || (!complete && i != (self + 1) % peers.size()))
+        {
+            continue;
+        }
+        int connection = open_socket(peers[i], false);
+        if (connection < 0)
+        {
+            continue;
+        }
+        size_t done = 0;
+        while (done < message.size())
+        {
+            int num = send(connection, message.data() + done, message.size() - done, MSG_NOSIGNAL);
+            if (num <= 0)
+            {
+                break;
+            }
+            done += num;
+        }
+        close(connection);
+    }
+}
+
+/**
+ * This function is used to take the best packing received for an instance since the last call.
+ *
+ * @param identifier    string type, the identifier of the instance.
+ * @param packing       vector<vector<int>> reference type, set to the item indexes of every bin of the packing.
+ * @return              bool type, false if nothing has been received for the instance.
+ */
+bool Island::receive(string identifier, vector<vector<int>> &packing)
+{
+    lock_guard<mutex> guard(inbox_lock);
+    map<string, vector<vector<int>>>::iterator kept = inbox.find(identifier);
+    if (kept == inbox.end())
+    {
+        return false;
+    }
+    packing = kept->second;
+    inbox.erase(kept);
+    return true;
+}
+
+/**
+ * This class is the options of solving an instance.
+ * max_time:        the maximum time of running an instance in seconds.
+ * seed:            the seed of the first search, the other searches take the following seeds, fixed so that a run can be
+ *                  repeated, time(NULL) for a different run every time.
+ * threads:         the number of independent searches run at the same time, the best one is kept.
+ * config:          the settings of the search, the default ones unless tuned.
+ * scale:           use the large-instance mode whatever the size of the instance.
+ * reduce:          fix the bins proved optimal by the Martello-Toth reductions before the search.
+ * bin_types:       the bin types to minimise the cost of, empty for bins of the capacity of the instance.
+ * max_items:       the maximum number of items in a bin, 0 for no maximum.
+ * conflicts:       the pairs of item indexes of the instance that must not share a bin.
+ * target:          the number of bins at which the search stops, 0 to search until the time limit.
+ */
+struct SolverOptions
+{
+    int max_time = 1;
+    unsigned seed = 0;
+    int threads = 1;
+    SearchConfig config;
+    bool scale = false;
+    bool reduce = true;
+    vector<BinType> bin_types;
+    int max_items = 0;
+    vector<pair<int, int>> conflicts;
+    int target = 0;
+};
+
+/**
+ * The number of items from which an instance is solved in the large-instance mode: the initial solution is built by best
+ * fit decreasing over size classes instead of relaxed mbs, so that every phase takes at most O(n log n).
+ */
+const int LARGE_INSTANCE = 10000;
+
+/**
+ * This function is used to build the initial solution: by relaxed mbs, or by best fit decreasing in the large-instance mode.
+ *
+ * @param solution      Solution reference type, the solution to initialize.
+ * @param problem       Problem reference type, the instance.
+ * @param options       const SolverOptions reference type, the options.
+ */
+void initialize_solution(Solution &solution, Problem &problem, const SolverOptions &options)
+{
+    if ((options.scale || problem.get_num_items() >= LARGE_INSTANCE) && (options.max_items > 0 || !options.conflicts.empty()))
+    {
+        solution.initialize_constrained(problem);
+    }
+    else if (options.scale || problem.get_num_items() >= LARGE_INSTANCE)
+    {
+        solution.initialize_large(problem);
+    }
+    else
+    {
+        solution.initialize(factor(problem.get_num_items(), options.config), problem);
+    }
+}
+
+/**
+ * This function is used to solve a single problem instance: fix the bins found by the reductions, get the initial solution
+ * of the other items by relaxed mbs, or from a previous packing if one is given and valid, and improve it by VNS.
+ *
+ * @param problem       Problem type, the instance.
+ * @param options       SolverOptions type, the options, only one search is run, the threads search its large neighborhoods.
+ * @param cancel        const atomic<bool> pointer type, the flag that stops the search early, nullptr if never.
+ * @param warm          const vector<vector<int>> pointer type, a previous packing to start from, nullptr if none.
+ * @param progress      Progress pointer type, where the new best solutions are reported, nullptr if none.
+ * @param island        Island pointer type, the island exchanging packings with the other processes, nullptr if none.
+ * @return              Solution type, the solved instance.
+ */
+Solution solve_instance(Problem problem, SolverOptions options, const atomic<bool> *cancel, const vector<vector<int>> *warm, Progress *progress = nullptr, Island *island = nullptr)
+{
+    vector<Bin> fixed;
+    bool constrained = options.max_items > 0 || !options.conflicts.empty();
+    if (options.reduce && warm == nullptr && options.bin_types.empty() && !constrained)
+    { // A previous packing covers all the items, so nothing is fixed when starting from one. The reductions prove bins
+      // optimal for the number of bins without side constraints, not for their cost.
+        fixed = problem.reduce();
+    }
+    Solution solution(problem);
+    unique_ptr<WorkStealingPool> pool;
+    if (options.threads > 1 && problem.items.size() >= PARALLEL_BINS)
+    { // Enough items for PARALLEL_BINS bins.
+        pool.reset(new WorkStealingPool(options.threads - 1));
+        solution.set_pool(pool.get());
+    }
+    unique_ptr<Constraints> constraints;
+    if (constrained)
+    {
+        constraints.reset(new Constraints(options.max_items, options.conflicts));
+        solution.set_constraints(constraints.get());
+    }
+    solution.set_cancel(cancel);
+    solution.set_seed(options.seed);
+    solution.set_config(options.config);
+    if (options.target > 0)
+    { // The fixed bins count towards the target.
+        solution.set_target(max(1, options.target - (int)fixed.size()));
+    }
+    if (!options.bin_types.empty())
+    {
+        solution.set_bin_types(options.bin_types, problem);
+    }
+    if (warm == nullptr || !solution.warm_start(*warm, problem))
+    {
+        if (warm != nullptr)
+        {
+            cout << "Invalid warm start for " << problem.get_identifier() << ", use relaxed mbs instead" << endl;
+        }
+        if (options.bin_types.empty() || constrained)
+        { // The bins of the types are built without side constraints.
+            initialize_solution(solution, problem, options);
+        }
+        else
+        { // Start from the bins of the capacity or the bins of the types, the fewer over the limits and then the cheaper.
+            initialize_solution(solution, problem, options);
+            vector<Bin> uniform = solution.get_bins();
+            solution.initialize_types(problem, false);
+            vector<Bin> typed = solution.get_bins();
+            if (solution.get_excess(typed) > 0)
+            { // Over the limits, try to leave the large types to the items that can share them.
+                solution.initialize_types(problem, true);
+                vector<Bin> tight = solution.get_bins();
+                long long excess = solution.get_excess(tight) - solution.get_excess(typed);
+                if (excess < 0 || (excess == 0 && solution.get_cost(tight) < solution.get_cost(typed)))
+                {
+                    typed = tight;
+                }
+            }
+            long long excess = solution.get_excess(uniform) - solution.get_excess(typed);
+            solution.set_bins(excess < 0 || (excess == 0 && solution.get_cost(uniform) < solution.get_cost(typed)) ? uniform : typed);
+        }
+    }
+    if (progress != nullptr)
+    {
+        vector<Bin> initial = solution.get_bins();
+        progress->start(problem.get_identifier(), problem.get_best_solution(), fixed);
+        progress->improved(initial);
+        solution.set_progress(progress);
+    }
+    vector<Bin> bins;
+    if (island == nullptr)
+    {
+        bins = solution.VNS(options.max_time);
+    }
+    else
+    { // Search in epochs of the migration interval, the best packings are exchanged between the epochs.
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        double left = options.max_time;
+        while (true)
+        {
+            bins = solution.VNS(min(left, island->get_interval()));
+            left = options.max_time - chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            island->migrate(problem.get_identifier(), bins);
+            vector<vector<int>> migrant;
+            if (island->receive(problem.get_identifier(), migrant))
+            {
+                Solution other(problem);
+                vector<Bin> theirs;
+                other.set_constraints(constraints.get());
+                if (other.warm_start(migrant, problem))
+                {
+                    theirs = other.get_bins();
+                }
+                if (!theirs.empty() && solution.evaluation(theirs, bins))
+                { // The neighbour has found better.
+                    if (progress != nullptr && theirs.size() < bins.size())
+                    {
+                        progress->improved(theirs);
+                    }
+                    bins = theirs;
+                }
+            }
+            solution.set_bins(bins);
+            if (left <= 0 || (cancel != nullptr && cancel->load()))
+            {
+                break;
+            }
+        }
+    }
+    fixed.insert(fixed.end(), bins.begin(), bins.end()); // The fixed bins come first in the output.
+    if (!options.bin_types.empty())
+    { // The caller checks is_within_limits, a solution over the limits is not feasible.
+        solution.assign_types(fixed);
+    }
+    solution.set_bins(fixed);
+    solution.set_objective(options.bin_types.empty() ? fixed.size() : solution.get_cost(fixed));
+    if (progress != nullptr)
+    {
+        progress->finish(fixed);
+    }
+    return solution;
+}
+
+/**
+ * This function is used to solve again an instance that has changed by a few items since a previous packing. The packing
+ * is repaired by best fit and then improved by a short VNS whose moves grow with the size of the change. Updating the
+ * items and the bins still takes a few linear passes over the instance, but no initial solution is built again. If the
+ * packing does not fit the old instance, the changed instance is solved from the beginning.
+ *
+ * @param problem       Problem type, the instance before the change.
+ * @param packing       vector<vector<int>> type, the previous packing of the instance.
+ * @param added         vector<int> type, the sizes of the added items.
+ * @param removed       vector<int> type, the indexes of the removed items.
+ * @param options       SolverOptions type, the options, only one search is run.
+ * @param progress      Progress pointer type, where the new best solutions are reported, nullptr if none.
+ * @return              Solution type, the solved instance.
+ */
+Solution resolve_instance(Problem problem, vector<vector<int>> packing, vector<int> added, vector<int> removed, SolverOptions options, Progress *progress = nullptr)
+{
+    Solution solution(problem);
+    solution.set_seed(options.seed);
+    solution.set_config(options.config);
+    if (!solution.warm_start(packing, problem))
+    {
+        cout << "Invalid warm start for " << problem.get_identifier() << ", use relaxed mbs instead" << endl;
+        problem.update(added, removed);
+        return solve_instance(problem, options, nullptr, nullptr, progress);
+    }
+    solution.apply_delta(problem, added, removed);
+    if (progress != nullptr)
+    { // Nothing is fixed, the repaired packing is the first best.
+        vector<Bin> repaired = solution.get_bins();
+        progress->start(problem.get_identifier(), problem.get_best_solution(), vector<Bin>());
+        progress->improved(repaired);
+        solution.set_progress(progress);
+    }
+    solution.set_move_limit(20 * (added.size() + removed.size()) + 1);
+    solution.set_shake_timeout(0.001);
+    solution.set_bins(solution.VNS(options.max_time));
+    solution.set_objective(solution.get_bins().size());
+    if (progress != nullptr)
+    {
+        vector<Bin> bins = solution.get_bins();
+        progress->finish(bins);
+    }
+    return solution;
+}
+
+/**
+ * The strategies the portfolio can race on an instance:
+ * mbs-vns:         the initial solution by relaxed mbs improved by VNS, as solve_instance.
+ * ffd:             the Martello-Toth reductions and best fit decreasing, without search.
+ * dp:              the reductions and every bin filled as full as possible by dynamic programming, without search.
+ */
+const vector<string> STRATEGIES = {"mbs-vns", "ffd", "dp"};
+
+/**
+ * This function is used to run one strategy of the portfolio on an instance.
+ *
+ * @param strategy      string type, the name of the strategy.
+ * @param problem       Problem type, the instance.
+ * @param options       SolverOptions type, the options.
+ * @param cancel        const atomic<bool> pointer type, the flag that stops the strategy early.
+ * @param warm          const vector<vector<int>> pointer type, a previous packing for mbs-vns to start from, nullptr if none.
+ * @return              unique_ptr<Solution> type, the solved instance, empty if the strategy has been stopped before
+ *                      packing every item.
+ */
+unique_ptr<Solution> solve_strategy(string strategy, Problem problem, SolverOptions options, const atomic<bool> *cancel, const vector<vector<int>> *warm)
+{
+    if (strategy == "mbs-vns")
+    {
+        return unique_ptr<Solution>(new Solution(solve_instance(problem, options, cancel, warm)));
+    }
+    vector<Bin> fixed;
+    if (options.reduce)
+    {
+        fixed = problem.reduce();
+    }
+    unique_ptr<Solution> solution(new Solution(problem));
+    if (strategy == "ffd")
+    {
+        solution->initialize_large(problem);
+    }
+    else if (!solution->initialize_dp(problem, cancel, options.max_time))
+    {
+        return nullptr;
+    }
+    vector<Bin> bins = solution->get_bins();
+    fixed.insert(fixed.end(), bins.begin(), bins.end());
+    solution->set_bins(fixed);
+    solution->set_objective(fixed.size());
+    return solution;
+}
+
+/**
+ * This function is used to race several strategies on an instance at the same time under the same time budget. As soon as
+ * a strategy reaches the lower bound of the number of bins, the others are cancelled and give back what they have. The
+ * fewest bins win, the strategy that finished first on a tie. A line is written to the report for every instance:
+ * "<identifier> <winner> <bins> <lower bound> <seconds>" and then "<strategy>=<bins>@<seconds>" for every strategy, with
+ * "-" as bins for a strategy stopped before packing every item. If every strategy has been stopped so, ffd is run after
+ * the race and wins, it is written last. A previous packing is given to mbs-vns, and the winner is reported to the
+ * progress as the one solution of the instance, once the race is over.
+ *
+ * @param problem       Problem type, the instance.
+ * @param options       SolverOptions type, the options, max_time is the budget of the whole race.
+ * @param strategies    vector<string> type, the names of the strategies.
+ * @param report        ostream reference type, where the result of the race is written.
+ * @param warm          const vector<vector<int>> pointer type, a previous packing to start from, nullptr if none.
+ * @param progress      Progress pointer type, where the solution of the winner is reported, nullptr if none.
+ * @return              Solution type, the solution of the winner.
+ */
+Solution run_portfolio(Problem problem, SolverOptions options, vector<string> strategies, ostream &report, const vector<vector<int>> *warm = nullptr, Progress *progress = nullptr)
+{
+    atomic<bool> cancel(false);
+    long long total = 0;
+    for (int i = 0; i < problem.items.size(); i++)
+    {
+        total += problem.items[i].get_size();
+    }
+    int bound = (total + problem.get_capacity() - 1) / problem.get_capacity();
+    options.target = bound;
+    vector<unique_ptr<Solution>> results(strategies.size());
+    vector<double> seconds(strategies.size(), 0);
+    vector<thread> runners;
+    mutex results_lock;
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    for (int i = 0; i < strategies.size(); i++)
+    {
+        runners.push_back(thread([&, i]
+                                 {
+            unique_ptr<Solution> solution = solve_strategy(strategies[i], problem, options, &cancel, warm);
+            lock_guard<mutex> guard(results_lock);
+            seconds[i] = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+            if (solution && solution->get_objective() <= bound)
+            { // Nothing can do better.
+                cancel = true;
+            }
+            results[i] = move(solution); }));
+    }
+    for (int i = 0; i < runners.size(); i++)
+    {
+        runners[i].join();
+    }
+    int winner = -1;
+    for (int i = 0; i < strategies.size(); i++)
+    {
+        if (results[i] && (winner == -1 || results[i]->get_objective() < results[winner]->get_objective() || (results[i]->get_objective() == results[winner]->get_objective() && seconds[i] < seconds[winner])))
         {
-            return false;
+            winner = i;
         }
     }
-    else
-    { // If new solution has more bins.
-        int num;
-        int max_left = 0;
-        for (int i = 0; i < before.size(); i++)
+    if (winner == -1)
+    { // Every strategy has been stopped before packing every item, ffd always finishes.
+        strategies.push_back("ffd");
+        results.push_back(solve_strategy("ffd", problem, options, nullptr, nullptr));
+        seconds.push_back(chrono::duration<double>(chrono::steady_clock::now() - startTime).count());
+        winner = strategies.size() - 1;
+    }
+    report << problem.get_identifier() << " " << strategies[winner] << " " << results[winner]->get_objective() << " " << bound << " " << seconds[winner];
+    for (int i = 0; i < strategies.size(); i++)
+    {
+        report << " " << strategies[i] << "=";
+        if (results[i])
         {
-            if (max_left < before[i].get_cap_left())
-            {
-                max_left = before[i].get_cap_left();
-                num = i;
-            }
+            report << results[i]->get_objective();
         }
-        // If there is one item in the new bin has fewer size than any item in the bin with the maximal residual capacity.
-        for (int i = 0; i < after.back().packed_items.size(); i++)
+        else
         {
-            for (int k = 0; k < after[num].packed_items.size(); i++)
-            {
-                if (after.back().packed_items[i].get_size() < after[num].packed_items[k].get_size())
-                {
-                    return true;
-                }
-            }
+            report << "-";
         }
-        return false;
+        report << "@" << seconds[i];
+    }
+    report << endl;
+    if (progress != nullptr)
+    {
+        vector<Bin> bins = results[winner]->get_bins();
+        progress->start(problem.get_identifier(), problem.get_best_solution(), vector<Bin>());
+        progress->improved(bins);
+        progress->finish(bins);
     }
+    return *results[winner];
 }
 
 /**
- * This is the first neighborhood of VNS.
- * This action selects a item from the bin that has the largest residual capacity and tries to move the smallest item
- * to the rest of bins by using best fit descent.
+ * This function is used to read the changes of the instances. An instance starts with its identifier line beginning with
+ * a quote as in the data file, followed by one line "+ <size>" for every added item and "- <index>" for every removed item.
  *
- * @param answer        vector<Bin>type, the used bins of the old solution.
- * @return              vector<Bin>type, the used bins of the new solution.
+ * @param inFile        istream reference type, the file of changes.
+ * @return              map<string, pair<vector<int>, vector<int>>> type, the added sizes and the removed indexes by the
+ *                      instance identifier.
  */
-vector<Bin> Solution::shift(vector<Bin> answer)
+map<string, pair<vector<int>, vector<int>>> read_deltas(istream &inFile)
 {
-    vector<Bin> temp = answer;
-    int index_max_residual = -1;
-    int index_min_residual = -1;
-    int max_residual = 0;
-    int minimum_cap = get_capacity();
-    for (int i = 0; i < temp.size(); i++)
-    { // Get the index of the bin with the largest residual capacity.
-        if (temp[i].get_cap_left() > max_residual)
+    map<string, pair<vector<int>, vector<int>>> deltas;
+    pair<vector<int>, vector<int>> *delta = nullptr;
+    string str;
+    while (getline(inFile, str))
+    {
+        if (!str.empty() && str.back() == '\r')
         {
-            max_residual = temp[i].get_cap_left();
-            index_max_residual = i; // Index of max residual.
+            str.pop_back();
         }
-    }
-    for (int i = 0; i < temp.size(); i++)
-    { // Get the index of the bin that has the minimum residual capacity if it encases the item removed out.
-        if (i == index_max_residual)
+        if (str.empty())
         {
             continue;
         }
-        if (temp[i].get_cap_left() >= temp[index_max_residual].packed_items.back().get_size())
-        {                                                                                                // If it can be packed.
-            int rest = temp[i].get_cap_left() - temp[index_max_residual].packed_items.back().get_size(); // Get the size after packed.
-            if (rest < minimum_cap)
-            { // Get the minimum index and residual capacity.
-                index_min_residual = i;
-                minimum_cap = rest;
-            }
+        if (str[0] == '\'')
+        {
+            delta = &deltas[str.substr(1)];
         }
-    }
-
-    if ((index_max_residual == -1) || (index_min_residual == -1))
-    { // If no where could be packed, then go to the next neighborhood.
-        return answer;
-    }
-    else
-    {
-        // Move the smallest item from the bin which has max left capacity to the most compact bin that can encase the item.
-        Item item(temp[index_max_residual].packed_items.back().get_size());
-        item.setIndex(temp[index_max_residual].packed_items.back().getIndex());
-        temp[index_max_residual].set_cap_left(temp[index_max_residual].get_cap_left() + item.get_size());
-        temp[index_max_residual].packed_items.pop_back();
-        temp[index_min_residual].encase(item);
-        if (temp[index_max_residual].packed_items.empty())
+        else if (delta != nullptr && str[0] == '+')
         {
-            temp.erase(temp.begin() + index_max_residual);
+            delta->first.push_back(atoi(str.c_str() + 1));
+        }
+        else if (delta != nullptr && str[0] == '-')
+        {
+            delta->second.push_back(atoi(str.c_str() + 1));
         }
-        return temp;
     }
+    return deltas;
 }
 
 /**
- * This is the second neighborhood of VNS.
- * This action picks the largest item from the item which has the maximal residual capacity and
- * tries to change it with another smaller item from other bins by using best fit descent.
+ * This function is used to check the change of an instance before it is applied: every added item must fit in a bin and
+ * every removed index must be an item of the instance.
  *
- * @param answer        vector<Bin>type, the used bins of the old solution.
- * @return              vector<Bin>type, the used bins of the new solution.
+ * @param problem       Problem reference type, the instance before the change.
+ * @param added         vector<int> reference type, the sizes of the added items.
+ * @param removed       vector<int> reference type, the indexes of the removed items.
+ * @return              bool type, true if the change can be applied.
  */
-vector<Bin> Solution::exchange_largest(vector<Bin> answer)
+bool check_delta(Problem &problem, vector<int> &added, vector<int> &removed)
 {
-    vector<Bin> temp = answer;
-    int index_max_residual = -1;
-    int index_largest;
-    int max_residual = 0;
-    for (int i = 0; i < temp.size(); i++)
-    { // Get the index of the bin with the largest residual capacity.
-        if (temp[i].get_cap_left() > max_residual)
+    for (int i = 0; i < added.size(); i++)
+    {
+        if (added[i] < 1 || added[i] > problem.get_capacity())
         {
-            max_residual = temp[i].get_cap_left();
-            index_max_residual = i;
+            return false;
         }
     }
-    max_residual = 0;
-    for (int i = 0; i < temp[index_max_residual].packed_items.size(); i++)
-    { // Get the largest item in the bin with the largest residual capacity.
-        if (temp[index_max_residual].packed_items[i].get_size() > max_residual)
+    for (int i = 0; i < removed.size(); i++)
+    {
+        if (removed[i] < 0 || removed[i] >= problem.get_next_index())
         {
-            max_residual = temp[index_max_residual].packed_items[i].get_size();
-            index_largest = i;
+            return false;
         }
     }
-    int index_change = -1;
-    int index_change_item = -1;
-    int residual = 0;
-    /**
-     * To find an item smaller then the item in other bin that could be swapped.
-     */
-    for (int i = 0; i < temp.size(); i++)
-    {
-        if (i == index_max_residual)
+    return true;
+}
+
+/**
+ * This function is used to write the bins of an instance in the solution format: the identifier, the objective and the
+ * abs-gap, and then one line of item indexes per bin.
+ *
+ * @param out           ostream reference type, the target stream.
+ * @param identifier    string type, the identifier of the instance.
+ * @param objective     int type, the number of bins.
+ * @param abs_gap       int type, the abs-gap.
+ * @param bins          vector<Bin> reference type, the bins.
+ */
+void write_bins(ostream &out, string identifier, int objective, int abs_gap, vector<Bin> &bins)
+{
+    out << endl
+        << identifier << endl
+        << "obj=    " << objective << "    " << abs_gap;
+    if (!bins.empty() && bins[0].get_type() >= 0)
+    { // The bin type of every bin, in the order of the bins.
+        out << endl
+            << "types=";
+        for (int i = 0; i < bins.size(); i++)
         {
-            continue;
+            out << "    " << bins[i].get_type();
         }
-        for (int k = 0; k < temp[i].packed_items.size(); k++)
+    }
+    for (int i = 0; i < bins.size(); i++)
+    {
+        out << endl;
+        for (int k = 0; k < bins[i].packed_items.size(); k++)
         {
-            if ((0 < (temp[index_max_residual].get_cap_left() + temp[index_max_residual].packed_items[index_largest].get_size() - temp[i].packed_items[k].get_size())) && (temp[index_max_residual].get_cap_left() + temp[index_max_residual].packed_items[index_largest].get_size() - temp[i].packed_items[k].get_size() <= get_capacity()) && ((0 <= temp[i].get_cap_left() - temp[index_max_residual].packed_items[index_largest].get_size() + temp[i].packed_items[k].get_size()) && (temp[i].get_cap_left() - temp[index_max_residual].packed_items[index_largest].get_size() + temp[i].packed_items[k].get_size() < get_capacity())) && (temp[index_max_residual].packed_items[index_largest].get_size() > temp[i].packed_items[k].get_size()))
+            out << bins[i].packed_items[k].getIndex();
+            if (k != bins[i].packed_items.size() - 1)
             {
-                int val = temp[index_max_residual].get_cap_left() + temp[index_max_residual].packed_items[index_largest].get_size() - temp[i].packed_items[k].get_size();
-                if (val > residual)
-                {
-                    residual = val;
-                    index_change = i;
-                    index_change_item = k;
-                }
+                out << " ";
             }
         }
     }
-    if (index_change == -1 || index_change_item == -1)
-    { // If can't find then go to the next neighbourhood.
-        return answer;
+}
+
+/**
+ * This function is used to write a solved instance in the solution format.
+ *
+ * @param out           ostream reference type, the target stream.
+ * @param solution      Solution reference type, the solved instance.
+ */
+void write_solution(ostream &out, Solution &solution)
+{
+    vector<Bin> bins = solution.get_bins();
+    write_bins(out, solution.get_identifier(), solution.get_objective(), solution.get_abs_gap(), bins);
+}
+
+/**
+ * This function is the constructor of Progress and starts the writer.
+ *
+ * @param progress_file     string type, the file the events are appended to, empty for none.
+ * @param checkpoint_file   string type, the checkpoint file, empty for none.
+ * @param interval          double type, the seconds between two checkpoints.
+ */
+Progress::Progress(string progress_file, string checkpoint_file, double interval)
+{
+    if (!progress_file.empty())
+    {
+        progressFile.open(progress_file.c_str(), ios::out | ios::app);
     }
+    this->checkpoint_file = checkpoint_file;
+    this->interval = interval;
+    startTime = chrono::steady_clock::now();
+    num_finished = 0;
+    best_known = 0;
+    dirty = false;
+    stopping = false;
+    writer = thread(&Progress::write, this);
+}
 
-    Item item1(temp[index_max_residual].packed_items[index_largest].get_size());
-    item1.setIndex(temp[index_max_residual].packed_items[index_largest].getIndex());
-    Item item2(temp[index_change].packed_items[index_change_item].get_size());
-    item2.setIndex(temp[index_change].packed_items[index_change_item].getIndex());
-    // Find them successfully and swap them.
-    temp[index_max_residual].encase(item2);
-    temp[index_max_residual].packed_items.erase(temp[index_max_residual].packed_items.begin() + index_largest);
-    temp[index_change].encase(item1);
-    temp[index_change].packed_items.erase(temp[index_change].packed_items.begin() + index_change_item);
-    return temp;
+/**
+ * This function is the destructor of Progress. The events left and a last checkpoint are written before the writer stops.
+ */
+Progress::~Progress()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
 }
 
 /**
- * This is the third neighborhood of VNS.
- * This action picks the smallest item from the item which has the maximal residual capacity and tries to
- * change it with another smaller item from other bins by using best fit descents.
+ * This function is used to begin an instance. Its fixed bins are counted in every event and checkpoint.
  *
- * @param answer        vector<Bin>type, the used bins of the old solution.
- * @return              vector<Bin>type, the used bins of the new solution.
+ * @param identifier    string type, the identifier of the instance.
+ * @param best_known    int type, the best known number of bins, for the abs-gap.
+ * @param fixed         vector<Bin> type, the bins fixed before the search.
  */
-vector<Bin> Solution::exchange_smallest(vector<Bin> answer)
+void Progress::start(string identifier, int best_known, vector<Bin> fixed)
 {
-    vector<Bin> temp = answer;
-    int index_max_residual = -1;
-    int index_smallest;
-    int max_residual = 0;
-    for (int i = 0; i < temp.size(); i++)
-    { // Get the index of the bin with the largest residual capacity.
-        if (temp[i].get_cap_left() > max_residual)
-        {
-            max_residual = temp[i].get_cap_left();
-            index_max_residual = i;
-        }
+    lock_guard<mutex> guard(lock);
+    this->identifier = identifier;
+    this->best_known = best_known;
+    this->fixed = fixed;
+    best.clear();
+}
+
+/**
+ * This function is used by the search to record a new best solution of the current instance. It only queues an event and
+ * keeps a copy of the bins for the next checkpoint, so the search never waits for the disk.
+ *
+ * @param bins          vector<Bin> reference type, the new best bins without the fixed ones.
+ */
+void Progress::improved(vector<Bin> &bins)
+{
+    {
+        lock_guard<mutex> guard(lock);
+        int num_bins = fixed.size() + bins.size();
+        ostringstream event;
+        event << chrono::duration<double>(chrono::steady_clock::now() - startTime).count() << " " << identifier << " "
+              << num_bins << " " << num_bins - best_known;
+        events.push_back(event.str());
+        best = bins;
+        dirty = true;
     }
-    max_residual = get_capacity();
-    for (int i = 0; i < temp[index_max_residual].packed_items.size(); i++)
-    { // Get the smallest item in the bin with the largest residual capacity.
-        if (temp[index_max_residual].packed_items[i].get_size() < max_residual)
+    wake.notify_one();
+}
+
+/**
+ * This function is used to record the final bins of the current instance. They are written in every later checkpoint.
+ *
+ * @param bins          vector<Bin> reference type, all the bins of the instance including the fixed ones.
+ */
+void Progress::finish(vector<Bin> &bins)
+{
+    ostringstream out;
+    write_bins(out, identifier, bins.size(), bins.size() - best_known, bins);
+    lock_guard<mutex> guard(lock);
+    finished += out.str();
+    num_finished++;
+    best.clear();
+    fixed.clear();
+    identifier.clear();
+    dirty = true;
+}
+
+/**
+ * This function is the loop of the writer: append the queued events as soon as they come, and write a checkpoint when
+ * the interval has passed and something has changed.
+ */
+void Progress::write()
+{
+    chrono::steady_clock::time_point last = chrono::steady_clock::now();
+    unique_lock<mutex> guard(lock);
+    while (true)
+    {
+        wake.wait_for(guard, chrono::duration<double>(interval));
+        vector<string> pending;
+        pending.swap(events);
+        guard.unlock();
+        for (int i = 0; i < pending.size() && progressFile.is_open(); i++)
         {
-            max_residual = temp[index_max_residual].packed_items[i].get_size();
-            index_smallest = i;
+            progressFile << pending[i] << endl;
         }
-    }
-    /**
-     * To find an item smaller then the item in other bin that could be swapped.
-     */
-    int index_change = -1;
-    int index_change_item = -1;
-    int residual = 0;
-    for (int i = 0; i < temp.size(); i++)
-    {
-        if (i == index_max_residual)
+        guard.lock();
+        bool due = chrono::duration<double>(chrono::steady_clock::now() - last).count() >= interval;
+        if (dirty && (due || stopping) && !checkpoint_file.empty())
         {
-            continue;
+            write_checkpoint(); // Formats under the lock, writes without it.
+            last = chrono::steady_clock::now();
         }
-        for (int k = 0; k < temp[i].packed_items.size(); k++)
+        if (stopping && events.empty())
         {
-            if ((0 < (temp[index_max_residual].get_cap_left() + temp[index_max_residual].packed_items[index_smallest].get_size() - temp[i].packed_items[k].get_size())) && (temp[index_max_residual].get_cap_left() + temp[index_max_residual].packed_items[index_smallest].get_size() - temp[i].packed_items[k].get_size() <= get_capacity()) && ((0 <= temp[i].get_cap_left() - temp[index_max_residual].packed_items[index_smallest].get_size() + temp[i].packed_items[k].get_size()) && (temp[i].get_cap_left() - temp[index_max_residual].packed_items[index_smallest].get_size() + temp[i].packed_items[k].get_size() < get_capacity())) && (temp[index_max_residual].packed_items[index_smallest].get_size() > temp[i].packed_items[k].get_size()))
-            {
-                int val = temp[index_max_residual].get_cap_left() + temp[index_max_residual].packed_items[index_smallest].get_size() - temp[i].packed_items[k].get_size();
-                if (val > residual)
-                {
-                    residual = val;
-                    index_change = i;
-                    index_change_item = k;
-                }
-            }
+            return;
         }
     }
-    if (index_change == -1 || index_change_item == -1)
-    { // If can't find then go to the next neighborhood.
-        return answer;
+}
+
+/**
+ * This function is used to write the finished instances and the best bins of the current instance to the checkpoint file,
+ * in the solution format. The first line also gives the number of finished instances, which come first, so that --resume
+ * does not solve them again. The file is written beside and then renamed, so a checkpoint is never left half written. It is
+ * called with the lock held and releases it while writing.
+ */
+void Progress::write_checkpoint()
+{
+    ostringstream out;
+    int count = num_finished;
+    int done = num_finished;
+    out << finished;
+    if (!identifier.empty() && !best.empty())
+    {
+        vector<Bin> bins = fixed;
+        bins.insert(bins.end(), best.begin(), best.end());
+        write_bins(out, identifier, bins.size(), bins.size() - best_known, bins);
+        count++;
     }
-    Item item1(temp[index_max_residual].packed_items[index_smallest].get_size());
-    item1.setIndex(temp[index_max_residual].packed_items[index_smallest].getIndex());
-    Item item2(temp[index_change].packed_items[index_change_item].get_size());
-    item2.setIndex(temp[index_change].packed_items[index_change_item].getIndex());
-    // Find them successfully and swap them.
-    temp[index_max_residual].encase(item1);
-    temp[index_max_residual].packed_items.erase(temp[index_max_residual].packed_items.begin() + index_smallest);
-    temp[index_change].encase(item1);
-    temp[index_change].packed_items.erase(temp[index_change].packed_items.begin() + index_change_item);
-    return temp;
+    dirty = false;
+    lock.unlock();
+    string temporary = checkpoint_file + ".tmp";
+    ofstream checkpointFile(temporary.c_str(), ios::out);
+    checkpointFile << count << " " << done << out.str();
+    checkpointFile.close();
+    if (checkpointFile)
+    {
+        rename(temporary.c_str(), checkpoint_file.c_str());
+    }
+    lock.lock();
 }
 
 /**
- * This is the fourth neighborhood of the VNS.
- * This function is to randomly select half items from a bin that exceeds the average items per bin to a new bin.
+ * This class is a fixed group of worker threads that stay alive and run the submitted jobs one by one, so that a job does
+ * not pay for creating a thread.
+ */
+class ThreadPool
+{
+public:
+    ThreadPool(int);                  // Constructor of ThreadPool, start the workers.
+    ~ThreadPool();                    // Destructor of ThreadPool, finish the queued jobs and join the workers.
+    void submit(function<void()>);    // Queue a job for the workers.
+    const int get_num_workers();      // Get the number of workers.
+private:
+    void work();                      // The loop run by every worker.
+    vector<thread> workers;
+    queue<function<void()>> jobs;
+    mutex lock;
+    condition_variable ready;
+    bool stopping;
+};
+
+/**
+ * This function is the constructor of ThreadPool and starts the workers.
  *
- * @param answer        vector<Bin>type, the used bins of the old solution.
- * @return              vector<Bin>type, the used bins of the new solution.
+ * @param num_workers   int type, the number of workers, at least one worker is started.
  */
-vector<Bin> Solution::split(vector<Bin> answer)
+ThreadPool::ThreadPool(int num_workers)
 {
-    vector<Bin> temp = answer;
-    float total_items = 0.0;
-    float average_items;
-    for (int i = 0; i < temp.size(); i++)
+    stopping = false;
+    if (num_workers < 1)
     {
-        total_items += (float)temp[i].packed_items.size();
-        ;
+        num_workers = 1;
     }
-    average_items = total_items / (float)temp.size(); // To get the average items of per items in all bins.
-    vector<int> vec;
-    for (int i = 0; i < temp.size(); i++)
+    for (int i = 0; i < num_workers; i++)
     {
-        if (temp[i].packed_items.size() > average_items)
-        {
-            vec.push_back(i);
-        }
+        workers.push_back(thread(&ThreadPool::work, this));
     }
-    srand(time(NULL));
-    int random_select = rand() % vec.size();
-    int times = temp[vec[random_select]].packed_items.size() / 2;
-    Bin bin(get_capacity()); // Move half of items from a random bin to a new bin.
-    for (int i = 0; i < times; i++)
+}
+
+/**
+ * This function is the destructor of ThreadPool. The queued jobs are still run before the workers are joined.
+ */
+ThreadPool::~ThreadPool()
+{
     {
-        int index_item = rand() % temp[vec[random_select]].packed_items.size();
-        Item item(temp[vec[random_select]].packed_items[index_item].get_size());
-        temp[vec[random_select]].set_cap_left(temp[vec[random_select]].get_cap_left() + item.get_size());
-        bin.encase(item);
-        temp[vec[random_select]].packed_items.erase(temp[vec[random_select]].packed_items.begin() + index_item);
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (int i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
     }
-    temp.push_back(bin);
-    return temp;
 }
 
 /**
- * This is the shaking procedure of VNS.
- * This action picks randomly two items from different bins and swap them.
+ * This function is used to queue a job, the job is run by the first idle worker.
  *
- * @param answer        vector<Bin>type, the used bins of the old solution.
- * @return              vector<Bin>type, the used bins of the new solution.
+ * @param job           function<void()> type, the job to run.
  */
-vector<Bin> Solution::shaking(vector<Bin> answer)
+void ThreadPool::submit(function<void()> job)
 {
-    vector<Bin> temp = answer;
-    srand(time(NULL));
-    int random_select_bin1;
-    int random_select_item1;
-    int random_select_bin2;
-    int random_select_item2;
-    int a, b, c, d;
-    bool judge;
-    clock_t startTime, endTime;
-    startTime = clock();
-    do
     {
-        random_select_bin1 = rand() % temp.size(); // Randomly get the bins and indexes.
-        random_select_bin2 = rand() % temp.size();
-        random_select_item1 = rand() % temp[random_select_bin1].packed_items.size();
-        random_select_item2 = rand() % temp[random_select_bin2].packed_items.size();
-        a = temp[random_select_bin1].get_cap_left();
-        b = temp[random_select_bin2].get_cap_left();
-        c = temp[random_select_bin1].packed_items[random_select_item1].get_size();
-        d = temp[random_select_bin2].packed_items[random_select_item2].get_size();
-        judge = ((0 <= a + c - d) && (a + c - d <= get_capacity()) && (0 <= b - c + d) && (b - c + d) <= get_capacity() && (a != 0) && (b != 0) && (a != b));
-        endTime = clock();
-        if ((((double)(endTime - startTime) / CLOCKS_PER_SEC) >= 1) && !judge)
+        lock_guard<mutex> guard(lock);
+        jobs.push(job);
+    }
+    ready.notify_one();
+}
+
+/**
+ * This function is used to get the number of workers.
+ *
+ * @return              int type, the number of workers.
+ */
+const int ThreadPool::get_num_workers()
+{
+    return workers.size();
+}
+
+/**
+ * This function is the loop of every worker: wait for a job, run it and wait again until the pool is stopping.
+ */
+void ThreadPool::work()
+{
+    while (true)
+    {
+        function<void()> job;
         {
-            return answer;
+            unique_lock<mutex> guard(lock);
+            ready.wait(guard, [this]
+                       { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+            {
+                return;
+            }
+            job = jobs.front();
+            jobs.pop();
         }
-    } while (!judge); // Find two items from different bins then do next.
-    Item item1(temp[random_select_bin1].packed_items[random_select_item1].get_size());
-    item1.setIndex(temp[random_select_bin1].packed_items[random_select_item1].getIndex());
-    Item item2(temp[random_select_bin2].packed_items[random_select_item2].get_size());
-    item2.setIndex(temp[random_select_bin2].packed_items[random_select_item2].getIndex());
+        job();
+    }
+}
 
-    temp[random_select_bin1].packed_items.erase(temp[random_select_bin1].packed_items.begin() + random_select_item1);
-    temp[random_select_bin1].encase(item2);
-    temp[random_select_bin2].packed_items.erase(temp[random_select_bin2].packed_items.begin() + random_select_item2);
-    temp[random_select_bin2].encase(item1);
-    return temp;
+/**
+ * This class is used to solve bin packing from item sizes in memory without touching any file, so that the solver can be
+ * called from other programs. A Solver is meant to be kept and called again: the workers and the buffers of the last
+ * call are reused by the next one.
+ */
+class Solver
+{
+public:
+    Solver(SolverOptions);                             // Constructor of Solver.
+    void set_options(SolverOptions);                   // Change the options for the next calls.
+    const vector<int> &solve(const int *, int, int);   // Solve an instance and get the bin of every item.
+    const int get_num_bins();                          // Get the number of bins of the last call.
+private:
+    SolverOptions options;
+    unique_ptr<ThreadPool> pool;
+    vector<int> assignment;
+    vector<vector<Bin>> results;
+    int num_bins;
+};
+
+/**
+ * This function is the constructor of Solver and starts the workers if more than one search is run.
+ *
+ * @param options       SolverOptions type, the options.
+ */
+Solver::Solver(SolverOptions options)
+{
+    num_bins = 0;
+    set_options(options);
 }
 
 /**
- * This function is used to calculate the current number of used bins and the abs_gap.
+ * This function is used to change the options. The workers are started again only if the number of threads changes.
  *
- * @param objective     int type, the number of the current used bins.
+ * @param options       SolverOptions type, the options.
  */
-void Solution::set_objective(int objective)
+void Solver::set_options(SolverOptions options)
 {
-    this->objective = objective;
-    this->abs_gap = objective - best_known;
+    this->options = options;
+    if (options.threads > 1 && (!pool || pool->get_num_workers() != options.threads))
+    {
+        pool.reset(new ThreadPool(options.threads));
+    }
 }
 
 /**
- * This function is used to get the current number of used bins.
+ * This function is used to solve an instance. The initial solution is built once and every thread improves
+ * its own copy by VNS with a different seed, and the solution with the fewest bins is kept.
  *
- * @return              int type, the number of the current used bins.
+ * @param sizes         const int pointer type, the sizes of the items.
+ * @param num_items     int type, the number of items.
+ * @param capacity      int type, the capacity of bins.
+ * @return              const vector<int> reference type, the bin of every item in the order of sizes, valid until the next call.
  */
-const float Solution::get_objective()
+const vector<int> &Solver::solve(const int *sizes, int num_items, int capacity)
 {
-    return objective;
+    Problem problem("", capacity, sizes, num_items, 0);
+    vector<Bin> fixed;
+    if (options.reduce)
+    {
+        fixed = problem.reduce();
+    }
+    Solution solution(problem);
+    solution.set_config(options.config);
+    initialize_solution(solution, problem, options);
+    int threads = max(1, options.threads);
+    results.resize(threads);
+    if (threads == 1)
+    {
+        solution.set_seed(options.seed);
+        results[0] = solution.VNS(options.max_time);
+    }
+    else
+    {
+        mutex lock;
+        condition_variable finished;
+        int remaining = threads;
+        for (int i = 0; i < threads; i++)
+        {
+            pool->submit([this, i, &solution, &lock, &finished, &remaining]
+                         {
+                Solution search = solution;
+                search.set_seed(options.seed + i);
+                results[i] = search.VNS(options.max_time);
+                lock_guard<mutex> guard(lock);
+                if (--remaining == 0)
+                {
+                    finished.notify_one();
+                } });
+        }
+        unique_lock<mutex> guard(lock);
+        finished.wait(guard, [&remaining]
+                      { return remaining == 0; });
+    }
+    int best = 0;
+    for (int i = 1; i < threads; i++)
+    {
+        if (results[i].size() < results[best].size())
+        {
+            best = i;
+        }
+    }
+    assignment.assign(num_items, -1);
+    for (int i = 0; i < fixed.size(); i++)
+    { // The fixed bins come first.
+        for (int k = 0; k < fixed[i].packed_items.size(); k++)
+        {
+            assignment[fixed[i].packed_items[k].getIndex()] = i;
+        }
+    }
+    for (int i = 0; i < results[best].size(); i++)
+    {
+        for (int k = 0; k < results[best][i].packed_items.size(); k++)
+        {
+            assignment[results[best][i].packed_items[k].getIndex()] = fixed.size() + i;
+        }
+    }
+    num_bins = fixed.size() + results[best].size();
+    return assignment;
 }
+
 /**
- * This function is used to get the capacity of the solution.
+ * This function is used to get the number of bins found by the last call of solve.
  *
- * @return              int type, the capacity of the solution.
+ * @return              int type, the number of bins.
  */
-const int Solution::get_capacity()
+const int Solver::get_num_bins()
 {
-    return capacity;
+    return num_bins;
 }
 
 /**
- * This function is used to get the current bins of the solution.
+ * This class is used to run the solver as a long-running server on a Unix domain socket, so that solving an instance does
+ * not pay for starting a new process.
  *
- * @return              vector<Bin> type, the current bins of the solution.
+ * Protocol (one request per connection):
+ * 1. The client sends an optional line "t=<seconds>" for the time budget of each instance in this request, otherwise the
+ * -t of the server is used. Then it sends the instances in the same text format as the data file.
+ * 2. The server solves the instances one by one on a worker of the pool and writes back the same format as the solution
+ * file, each instance as soon as it is solved. Then the connection is closed.
+ * 3. The client cancels the request by sending a line "CANCEL" or by closing the connection. The instance being solved
+ * stops at once and nothing more is written.
  */
-vector<Bin> Solution::get_bins()
+class Server
 {
-    return bins;
+public:
+    Server(string, int, int);         // Constructor of Server.
+    int run();                        // Listen on the socket and serve the requests, returns only on error.
+private:
+    void handle(int);                 // Read, solve and answer a request on a connection.
+    void watch();                     // Watch the connections being solved for cancellation.
+    bool read_line(int, string &, string &); // Read a line from a connection.
+    bool send_all(int, const string &);      // Write a whole string to a connection.
+    string path;
+    int max_time;
+    int num_workers;
+    map<int, shared_ptr<atomic<bool>>> solving; // The connections being solved and their cancel flags.
+    mutex solving_lock;
+};
+
+/**
+ * This function is the constructor of Server.
+ *
+ * @param path          string type, the path of the Unix domain socket.
+ * @param max_time      int type, the default maximum time of running a single instance.
+ * @param num_workers   int type, the number of instances solved at the same time.
+ */
+Server::Server(string path, int max_time, int num_workers)
+{
+    this->path = path;
+    this->max_time = max_time;
+    this->num_workers = num_workers;
 }
 
 /**
- * This function is used to get the identifier of the current solution.
+ * This function is used to bind the socket, start the warm workers and the watcher, and accept connections forever.
  *
- * @return              string type, the identifier of the instance.
+ * @return              int type, -1 if the socket can not be used.
  */
-const string Solution::get_identifier()
+int Server::run()
 {
-    return identifier;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (listener < 0 || path.length() >= sizeof(address.sun_path))
+    {
+        cout << "Error opening server socket" << endl;
+        return -1;
+    }
+    strcpy(address.sun_path, path.c_str());
+    unlink(path.c_str()); // Remove the socket left by a previous server.
+    if (bind(listener, (sockaddr *)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0)
+    {
+        cout << "Error opening server socket" << endl;
+        close(listener);
+        return -1;
+    }
+    ThreadPool pool(num_workers);
+    thread watcher(&Server::watch, this);
+    watcher.detach();
+    while (true)
+    {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            continue;
+        }
+        pool.submit([this, connection]
+                    { handle(connection); });
+    }
 }
 
 /**
- * This function is used to get the abs_gap of the instance.
+ * This function is used to read a line from a connection. The bytes read after the line are kept in the buffer.
  *
- * @return              float type, the abs_gap of the instance
+ * @param connection    int type, the connection.
+ * @param buffer        string reference type, the bytes read but not used yet.
+ * @param line          string reference type, the line read without the line break.
+ * @return              bool type, false if the connection is closed before a whole line is read.
  */
-const float Solution::get_abs_gap()
+bool Server::read_line(int connection, string &buffer, string &line)
 {
-    return abs_gap;
+    size_t end;
+    while ((end = buffer.find('\n')) == string::npos)
+    {
+        char chunk[4096];
+        int num = recv(connection, chunk, sizeof(chunk), 0);
+        if (num <= 0)
+        {
+            if (buffer.empty())
+            {
+                return false;
+            }
+            buffer += '\n'; // The last line has no line break.
+            continue;
+        }
+        buffer.append(chunk, num);
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.pop_back();
+    }
+    return true;
 }
 
 /**
- * This function is used to set the currently used bins of the instance.
+ * This function is used to write a whole string to a connection.
  *
- * @param bins         vector<Bin> type, the currently used bins of the instance.
+ * @param connection    int type, the connection.
+ * @param data          const string reference type, the data to write.
+ * @return              bool type, false if the client has gone.
  */
-void Solution::set_bins(vector<Bin> bins)
+bool Server::send_all(int connection, const string &data)
 {
-    this->bins = bins;
+    size_t done = 0;
+    while (done < data.length())
+    {
+        int num = send(connection, data.c_str() + done, data.length() - done, MSG_NOSIGNAL);
+        if (num <= 0)
+        {
+            return false;
+        }
+        done += num;
+    }
+    return true;
 }
 
 /**
- * This function is used to regulate the left residual crack according to the capacity of the bins when using relaxed mbs.
+ * This function is used to serve a request: read all the instances of the request, solve them one by one and write back
+ * every solved instance at once.
  *
- * @param num           int type, the capacity of the bins in the instance.
- * @return              int type, the allowable slack.
+ * @param connection    int type, the connection of the request.
  */
-int factor(int num)
+void Server::handle(int connection)
 {
-    int temp;
-    if (num == 120)
+    string buffer;
+    string line;
+    string request;
+    int budget = max_time;
+    int problem_num;
+    bool complete = read_line(connection, buffer, line);
+    if (complete && line.compare(0, 2, "t=") == 0)
+    { // Time budget of this request.
+        budget = atoi(line.c_str() + 2);
+        complete = read_line(connection, buffer, line);
+    }
+    problem_num = atoi(line.c_str());
+    for (int i = 0; i < problem_num && complete; i++)
+    { // Read the identifier, the head line and the items of every instance.
+        string head;
+        int capacity = 0;
+        int num_items = 0;
+        complete = read_line(connection, buffer, line) && read_line(connection, buffer, head);
+        istringstream(head) >> capacity >> num_items;
+        request += line + "\n" + head + "\n";
+        for (int k = 0; k < num_items && complete; k++)
+        {
+            complete = read_line(connection, buffer, line);
+            request += line + "\n";
+        }
+    }
+    if (!complete || problem_num <= 0)
     {
-        temp = 3;
+        close(connection);
+        return;
     }
-    else if (num == 500)
+    shared_ptr<atomic<bool>> cancel = make_shared<atomic<bool>>(buffer.find("CANCEL") != string::npos);
     {
-        temp = 5;
+        lock_guard<mutex> guard(solving_lock);
+        solving[connection] = cancel;
     }
-    else
+    istringstream inFile(request);
+    send_all(connection, to_string(problem_num));
+    for (int i = 0; i < problem_num && !cancel->load(); i++)
     {
-        temp = 11000;
+        Problem problem(inFile);
+        SolverOptions options;
+        options.max_time = budget;
+        options.seed = time(NULL);
+        Solution solution = solve_instance(problem, options, cancel.get(), nullptr);
+        if (cancel->load())
+        {
+            break;
+        }
+        ostringstream outFile;
+        write_solution(outFile, solution);
+        if (!send_all(connection, outFile.str()))
+        {
+            break;
+        }
+    }
+    {
+        lock_guard<mutex> guard(solving_lock);
+        solving.erase(connection);
+    }
+    close(connection);
+}
+
+/**
+ * This function is the loop of the watcher. It polls all the connections being solved and raises the cancel flag of a
+ * request when its client sends "CANCEL" or closes the connection. A client that only shuts down writing has finished
+ * its request and waits for the reply, so its connection is no longer watched; a reply that can not be written stops the
+ * request in handle.
+ */
+void Server::watch()
+{
+    while (true)
+    {
+        vector<pollfd> fds;
+        vector<shared_ptr<atomic<bool>>> flags;
+        {
+            lock_guard<mutex> guard(solving_lock);
+            for (map<int, shared_ptr<atomic<bool>>>::iterator it = solving.begin(); it != solving.end(); it++)
+            {
+                pollfd fd = {it->first, POLLIN, 0};
+                fds.push_back(fd);
+                flags.push_back(it->second);
+            }
+        }
+        if (fds.empty())
+        {
+            this_thread::sleep_for(chrono::milliseconds(50));
+            continue;
+        }
+        poll(fds.data(), fds.size(), 50);
+        lock_guard<mutex> guard(solving_lock);
+        for (int i = 0; i < fds.size(); i++)
+        {
+            if (fds[i].revents == 0 || solving.count(fds[i].fd) == 0 || solving[fds[i].fd] != flags[i])
+            { // Nothing happened or the request has finished meanwhile.
+                continue;
+            }
+            char chunk[256];
+            int num = recv(fds[i].fd, chunk, sizeof(chunk) - 1, MSG_DONTWAIT);
+            if ((fds[i].revents & (POLLHUP | POLLERR)) || (num < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+            { // The client has gone, the reply can not be written.
+                flags[i]->store(true);
+            }
+            else if (num == 0)
+            { // The client has only shut down its side after the request, the reply is still expected.
+                solving.erase(fds[i].fd);
+            }
+            else if (num > 0)
+            {
+                chunk[num] = '\0';
+                if (strstr(chunk, "CANCEL") != nullptr)
+                {
+                    flags[i]->store(true);
+                }
+            }
+        }
     }
-    return temp;
 }
 
 /**
@@ -1009,12 +5031,38 @@ int factor(int num)
  * @param argc      int type, the number of arguments.
  * @param argv      array of pointers type, used to store the pointers that point to the string argument in command.
  * @return          Program ends.
+ *
+ * Define BPP_NO_MAIN to compile this file as a library without main, for the programs that use Solver.
  */
+#ifndef BPP_NO_MAIN
 int main(int argc, const char *argv[])
 {
     char data_file[30] = "";
     char solution_file[30] = "";
-    int max_time;
+    string server_socket;
+    string warm_file;
+    bool resume = false;
+    string delta_file;
+    string binary_file;
+    string progress_file;
+    string checkpoint_file;
+    double checkpoint_interval = 10;
+    int instance = -1;
+    int threads = 1;
+    string islands;
+    int island_index = 0;
+    double migration_interval = 1;
+    string topology = "ring";
+    string bin_types;
+    string conflict_file;
+    int max_items = 0;
+    string portfolio;
+    string portfolio_report;
+    string config_file;
+    int max_time = 1;
+    bool scale = false;
+    bool reduce = true;
+    int num_workers = thread::hardware_concurrency();
     for (int i = 1; i < argc; i = i + 2)
     { // Get the arguments.
         if (strcmp(argv[i], "-s") == 0)
@@ -1029,6 +5077,116 @@ int main(int argc, const char *argv[])
         {
             max_time = atoi(argv[i + 1]);
         }
+        else if (strcmp(argv[i], "--warm-start") == 0)
+        {
+            warm_file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--delta") == 0)
+        {
+            delta_file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--scale") == 0)
+        { // A flag without value.
+            scale = true;
+            i--;
+        }
+        else if (strcmp(argv[i], "--no-reduce") == 0)
+        { // A flag without value.
+            reduce = false;
+            i--;
+        }
+        else if (strcmp(argv[i], "--convert") == 0)
+        {
+            binary_file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--instance") == 0)
+        {
+            instance = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--progress") == 0)
+        {
+            progress_file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--checkpoint") == 0)
+        {
+            checkpoint_file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--checkpoint-interval") == 0)
+        {
+            checkpoint_interval = atof(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--resume") == 0)
+        { // A checkpoint is a solution file, so resuming is a warm start from it.
+            warm_file = argv[i + 1];
+            resume = true;
+        }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            threads = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--islands") == 0)
+        {
+            islands = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--island") == 0)
+        {
+            island_index = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--migration-interval") == 0)
+        {
+            migration_interval = atof(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--topology") == 0)
+        {
+            topology = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--bin-types") == 0)
+        {
+            bin_types = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--max-items") == 0)
+        {
+            max_items = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--conflicts") == 0)
+        {
+            conflict_file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--portfolio") == 0)
+        {
+            portfolio = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--portfolio-report") == 0)
+        {
+            portfolio_report = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--config") == 0)
+        {
+            config_file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--server") == 0)
+        {
+            server_socket = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--workers") == 0)
+        {
+            num_workers = atoi(argv[i + 1]);
+        }
+    }
+    if (!server_socket.empty())
+    { // Serve the requests on the socket instead of solving a data file.
+        Server server(server_socket, max_time, num_workers);
+        return server.run();
+    }
+    if (!binary_file.empty())
+    { // Convert the data file into a binary instance file instead of solving it.
+        ifstream textFile(data_file, ios::in);
+        if (!textFile || !InstanceFile::convert(textFile, binary_file))
+        {
+            cout << "Error converting source file" << endl;
+            return -1;
+        }
+        return 0;
     }
     string str;
     ifstream inFile;
@@ -1042,33 +5200,235 @@ int main(int argc, const char *argv[])
         cout << "Error opening source file" << endl;
         return -1;
     }
+    if ((!warm_file.empty() || !delta_file.empty()) && InstanceFile::is_binary(data_file))
+    { // The instances of a binary file are solved from the beginning.
+        cout << "Error --warm-start, --resume and --delta can not be used with a binary instance file" << endl;
+        return -1;
+    }
+    map<string, vector<vector<int>>> packings;
+    if (!warm_file.empty())
+    { // Read the previous solutions to start from.
+        ifstream warmFile(warm_file.c_str(), ios::in);
+        if (!warmFile)
+        {
+            cout << "Error opening warm start file" << endl;
+            return -1;
+        }
+        packings = read_solutions(warmFile);
+    }
+    set<string> finished;
+    if (resume)
+    { // The instances the checkpoint has finished are only written again.
+        ifstream checkpointFile(warm_file.c_str(), ios::in);
+        finished = read_finished(checkpointFile);
+    }
+    map<string, pair<vector<int>, vector<int>>> deltas;
+    if (!delta_file.empty())
+    { // Read the changes of the instances since the warm start.
+        ifstream deltaFile(delta_file.c_str(), ios::in);
+        if (!deltaFile)
+        {
+            cout << "Error opening delta file" << endl;
+            return -1;
+        }
+        deltas = read_deltas(deltaFile);
+    }
+    map<string, vector<pair<int, int>>> conflicts;
+    if (!conflict_file.empty())
+    { // Read the pairs of items that must not share a bin.
+        ifstream conflictFile(conflict_file.c_str(), ios::in);
+        if (!conflictFile)
+        {
+            cout << "Error opening conflict file" << endl;
+            return -1;
+        }
+        conflicts = read_conflicts(conflictFile);
+    }
+    if (!deltas.empty() && (max_items > 0 || !conflicts.empty()))
+    { // The repair of a change packs the added items by capacity only.
+        cout << "Error --delta can not be used with --max-items or --conflicts" << endl;
+        return -1;
+    }
+    SolverOptions options;
+    options.max_time = max_time;
+    options.seed = time(NULL);
+    options.max_items = max_items;
+    options.scale = scale;
+    options.reduce = reduce;
+    options.threads = threads;
+    if (!config_file.empty())
+    { // The settings of the search, e.g. as tuned by tools/tune.cpp.
+        ifstream configFile(config_file.c_str(), ios::in);
+        if (!configFile || !read_config(configFile, options.config))
+        {
+            cout << "Error reading config file" << endl;
+            return -1;
+        }
+    }
+    if (!bin_types.empty() && !parse_bin_types(bin_types, options.bin_types))
+    {
+        cout << "Error reading bin types" << endl;
+        return -1;
+    }
+    if (checkpoint_interval <= 0)
+    {
+        cout << "Error the checkpoint interval must be positive" << endl;
+        return -1;
+    }
+    unique_ptr<Progress> progress;
+    if (!progress_file.empty() || !checkpoint_file.empty())
+    { // Report the search while it runs.
+        progress.reset(new Progress(progress_file, checkpoint_file, checkpoint_interval));
+    }
+    vector<string> strategies;
+    if (!portfolio.empty())
+    { // Race the strategies on every instance.
+        istringstream list(portfolio == "all" ? "mbs-vns,ffd,dp" : portfolio);
+        string strategy;
+        while (getline(list, strategy, ','))
+        {
+            if (find(STRATEGIES.begin(), STRATEGIES.end(), strategy) == STRATEGIES.end())
+            {
+                cout << "Error unknown strategy " << strategy << endl;
+                return -1;
+            }
+            strategies.push_back(strategy);
+        }
+        if (strategies.empty() || !options.bin_types.empty() || options.max_items > 0 || !conflicts.empty() || !islands.empty())
+        { // The islands exchange the packings of one search, not of a race.
+            cout << "Error --portfolio can not be used with --bin-types, --max-items, --conflicts or --islands" << endl;
+            return -1;
+        }
+    }
+    ofstream reportFile;
+    if (!portfolio_report.empty())
+    {
+        reportFile.open(portfolio_report.c_str(), ios::app);
+        if (!reportFile)
+        {
+            cout << "Error opening portfolio report file" << endl;
+            return -1;
+        }
+    }
+    ostream &report = portfolio_report.empty() ? cout : reportFile;
+    unique_ptr<Island> island;
+    if (!islands.empty())
+    { // Exchange the best packings with the other islands, every island searches from its own seed.
+        vector<string> peers;
+        istringstream list(islands);
+        string peer;
+        while (getline(list, peer, ','))
+        {
+            peers.push_back(peer);
+        }
+        island.reset(new Island(peers, island_index, topology == "complete", migration_interval));
+        if (island_index < 0 || island_index >= peers.size() || (topology != "ring" && topology != "complete") || migration_interval <= 0 || !island->open())
+        {
+            cout << "Error opening island" << endl;
+            return -1;
+        }
+        options.seed += island_index;
+    }
+    if (InstanceFile::is_binary(data_file))
+    { // Map the binary instance file and solve all the instances or only the chosen one.
+        InstanceFile binaryFile(data_file);
+        if (!binaryFile.is_open() || instance >= binaryFile.get_num_instances())
+        {
+            cout << "Error opening source file" << endl;
+            return -1;
+        }
+        int first = instance >= 0 ? instance : 0;
+        int last = instance >= 0 ? instance : binaryFile.get_num_instances() - 1;
+        outFile << last - first + 1;
+        for (int i = first; i <= last; i++)
+        {
+            if (!binaryFile.check_problem(i))
+            {
+                cout << "Error instance " << i << " of the binary file is damaged" << endl;
+                return -1;
+            }
+            Problem problem = binaryFile.get_problem(i);
+            options.conflicts = conflicts[problem.get_identifier()];
+            if (!options.bin_types.empty() && !fit_bin_types(problem, options.bin_types))
+            {
+                cout << "Error an item of " << problem.get_identifier() << " fits in no bin type" << endl;
+                return -1;
+            }
+            if (!strategies.empty())
+            {
+                Solution solution = run_portfolio(problem, options, strategies, report, nullptr, progress.get());
+                write_solution(outFile, solution);
+                continue;
+            }
+            Solution solution = solve_instance(problem, options, nullptr, nullptr, progress.get(), island.get());
+            if (!solution.is_within_limits())
+            {
+                cout << "Error not enough bins of the types for " << problem.get_identifier() << ", the limits can not be kept" << endl;
+                return -1;
+            }
+            write_solution(outFile, solution);
+        }
+        outFile.close();
+        return 0;
+    }
     getline(inFile, str);
     problem_num = atoi(str.c_str()); // Get the number of test problems
     outFile << problem_num;
     for (int i = 0; i < problem_num; i++)
     {
         Problem problem(inFile);
-        Solution solution(problem);
-        solution.initialize(factor(problem.get_num_items()), problem);
-        solution.set_bins(solution.VNS(max_time));
-        solution.set_objective(solution.get_bins().size()); // Print out.
-        outFile << endl
-                << solution.get_identifier() << endl
-                << "obj=    " << solution.get_objective() << "    " << solution.get_abs_gap();
-        for (int i = 0; i < solution.get_bins().size(); i++)
-        {
-            outFile << endl;
-            for (int k = 0; k < solution.get_bins()[i].packed_items.size(); k++)
+        options.conflicts = conflicts[problem.get_identifier()];
+        if (!options.bin_types.empty() && !fit_bin_types(problem, options.bin_types))
+        {
+            cout << "Error an item of " << problem.get_identifier() << " fits in no bin type" << endl;
+            return -1;
+        }
+        map<string, vector<vector<int>>>::iterator warm = packings.find(problem.get_identifier());
+        map<string, pair<vector<int>, vector<int>>>::iterator delta = deltas.find(problem.get_identifier());
+        if (delta != deltas.end() && !check_delta(problem, delta->second.first, delta->second.second))
+        {
+            cout << "Error the change of " << problem.get_identifier() << " has an item size out of 1.." << problem.get_capacity() << " or an unknown index" << endl;
+            return -1;
+        }
+        if (delta != deltas.end() && warm != packings.end())
+        { // Repair the previous packing for the change.
+            Solution solution = resolve_instance(problem, warm->second, delta->second.first, delta->second.second, options, progress.get());
+            write_solution(outFile, solution);
+            continue;
+        }
+        if (delta != deltas.end())
+        { // Nothing to start from, solve the changed instance.
+            problem.update(delta->second.first, delta->second.second);
+        }
+        if (delta == deltas.end() && warm != packings.end() && finished.count(problem.get_identifier()))
+        { // Finished before the job was stopped, the packing of the checkpoint is kept without searching.
+            SolverOptions kept = options;
+            kept.max_time = 0;
+            Solution solution = solve_instance(problem, kept, nullptr, &warm->second, progress.get());
+            if (!solution.is_within_limits())
             {
-                outFile << solution.get_bins()[i].packed_items[k].getIndex();
-                if (k != solution.get_bins()[i].packed_items.size() - 1)
-                {
-                    outFile << " ";
-                }
+                cout << "Error not enough bins of the types for " << problem.get_identifier() << ", the limits can not be kept" << endl;
+                return -1;
             }
+            write_solution(outFile, solution);
+            continue;
+        }
+        if (!strategies.empty())
+        {
+            Solution solution = run_portfolio(problem, options, strategies, report, warm == packings.end() ? nullptr : &warm->second, progress.get());
+            write_solution(outFile, solution);
+            continue;
+        }
+        Solution solution = solve_instance(problem, options, nullptr, warm == packings.end() ? nullptr : &warm->second, progress.get(), island.get());
+        if (!solution.is_within_limits())
+        {
+            cout << "Error not enough bins of the types for " << problem.get_identifier() << ", the limits can not be kept" << endl;
+            return -1;
         }
+        write_solution(outFile, solution); // Print out.
     }
     inFile.close();  // Close file stream.
     outFile.close(); // Close file stream.
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @File kernels.cpp
+ * @Brief Benchmark of the best fit decreasing kernels specialized for the standard capacities against the generic one.
+ * Both must give the same number of bins.
+ *
+ * Build and run from the repository root:
+ *     g++ -O2 -pthread bench/kernels.cpp -o kernels && ./kernels [items, default 1000000]
+ */
+
+#define BPP_NO_MAIN
+#include "../20217275.cpp"
+
+/**
+ * This function is used to get the time passed since a moment in milliseconds.
+ *
+ * @param start         chrono::steady_clock::time_point type, the moment.
+ * @return              double type, the milliseconds passed.
+ */
+double elapsed(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, const char *argv[])
+{
+    int num_items = argc > 1 ? atoi(argv[1]) : 1000000;
+    int capacities[] = {150, 1000, 10000};
+    int repeats = 5;
+    printf("%10s %10s %10s %14s %14s %10s\n", "capacity", "items", "bins", "generic ms", "specialized ms", "speedup");
+    for (int c = 0; c < 3; c++)
+    {
+        int capacity = capacities[c];
+        mt19937 rng(capacity);
+        vector<int> sizes(num_items);
+        for (int i = 0; i < num_items; i++)
+        { // Sizes between 2% and 60% of the capacity.
+            sizes[i] = capacity / 50 + rng() % (capacity * 3 / 5 - capacity / 50);
+        }
+        Problem problem("bench", capacity, sizes.data(), num_items, 0);
+        vector<int> bin_of;
+        int generic_bins = 0;
+        int specialized_bins = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int r = 0; r < repeats; r++)
+        {
+            generic_bins = best_fit_generic(problem, bin_of);
+        }
+        double generic = elapsed(start) / repeats;
+        start = chrono::steady_clock::now();
+        for (int r = 0; r < repeats; r++)
+        {
+            specialized_bins = best_fit(problem, bin_of);
+        }
+        double specialized = elapsed(start) / repeats;
+        if (generic_bins != specialized_bins)
+        {
+            printf("Different number of bins: %d and %d\n", generic_bins, specialized_bins);
+            return 1;
+        }
+        printf("%10d %10d %10d %14.1f %14.1f %9.1fx\n", capacity, num_items, specialized_bins, generic, specialized, generic / specialized);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * @File scaling.cpp
+ * @Brief Benchmark of the large-instance mode: times loading, construction, one VNS step and writing for instances from
+ * 1,000 items up to a given size, so that the time per item can be checked to stay flat as the instances grow.
+ *
+ * Build and run from the repository root:
+ *     g++ -O2 -pthread bench/scaling.cpp -o scaling && ./scaling [max items, default 1000000]
+ */
+
+#define BPP_NO_MAIN
+#include "../20217275.cpp"
+
+/**
+ * This function is used to get the time passed since a moment in milliseconds.
+ *
+ * @param start         chrono::steady_clock::time_point type, the moment.
+ * @return              double type, the milliseconds passed.
+ */
+double elapsed(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * This function is used to write a random instance in the data file format. The sizes are drawn from 80 distinct values
+ * so that sizes are duplicated as in real instances.
+ *
+ * @param num_items     int type, the number of items.
+ * @return              string type, the instance.
+ */
+string generate(int num_items)
+{
+    mt19937 rng(num_items);
+    ostringstream out;
+    out << "'scale_" << num_items << endl
+        << " 150 " << num_items << " 0" << endl;
+    for (int i = 0; i < num_items; i++)
+    {
+        out << 20 + rng() % 80 << endl;
+    }
+    return out.str();
+}
+
+int main(int argc, const char *argv[])
+{
+    int max_items = argc > 1 ? atoi(argv[1]) : 1000000;
+    int steps = 5;
+    printf("%10s %10s %12s %12s %12s %12s %12s\n", "items", "bins", "load ms", "construct ms", "step ms", "write ms", "ns/item");
+    for (int num_items = 1000; num_items <= max_items; num_items *= 10)
+    {
+        string text = generate(num_items);
+        istringstream inFile(text);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        Problem problem(inFile);
+        double load = elapsed(start);
+
+        start = chrono::steady_clock::now();
+        Solution solution(problem);
+        solution.initialize_large(problem);
+        double construct = elapsed(start);
+
+        vector<Bin> answer = solution.get_bins();
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < steps; i++)
+        { // One pass of the first two neighborhoods as VNS does.
+            vector<Bin> answer_new = solution.shift(answer);
+            if (solution.evaluation(answer_new, answer))
+            {
+                answer = answer_new;
+            }
+            answer_new = solution.exchange_largest(answer);
+            if (solution.evaluation(answer_new, answer))
+            {
+                answer = answer_new;
+            }
+        }
+        double step = elapsed(start) / steps;
+        solution.set_bins(answer);
+        solution.set_objective(answer.size());
+
+        ostringstream outFile;
+        start = chrono::steady_clock::now();
+        write_solution(outFile, solution);
+        double write = elapsed(start);
+
+        double total = load + construct + step + write;
+        printf("%10d %10d %12.1f %12.1f %12.1f %12.1f %12.1f\n", num_items, (int)answer.size(), load, construct, step, write,
+               total * 1e6 / num_items);
+    }
+    return 0;
+}
@@ -0,0 +1,354 @@
+/**
+ * @File tune.cpp
+ * @Brief A tool to tune the settings of the search (SearchConfig) per instance class by F-race. Random settings and the
+ * default ones race on the instances of a class one after another, every instance is solved by all the settings still in
+ * the race at the same time on all the cores, with the same seed. After a few instances, the Friedman test on the ranks
+ * of the numbers of bins drops the settings that are significantly worse than the best, until one is left or the budget
+ * of runs is spent. The class of an instance is its identifier without the last "_<number>" or the trailing digits.
+ *
+ * Build and run from the repository root:
+ *     g++ -O2 -pthread tools/tune.cpp -o tune
+ *     ./tune -s <data file> [-s <data file>...] [-t <seconds per run, default 1>] [--candidates <n, default 16>]
+ *            [--budget <runs per class, default 40 per candidate>] [--workers <n, default cores>] [--seed <n>]
+ *            [--output <directory>]
+ * The best settings of every class are printed and, with --output, written to <directory>/<class>.cfg to be given to the
+ * solver with --config.
+ */
+
+#define BPP_NO_MAIN
+#include "../20217275.cpp"
+
+/**
+ * The number of instances a race runs before its first test, as the test needs a few ranks to be meaningful.
+ */
+const int FIRST_TEST = 5;
+
+/**
+ * This function is used to get the class of an instance from its identifier.
+ *
+ * @param identifier    string type, the identifier of the instance.
+ * @return              string type, the class.
+ */
+string instance_class(string identifier)
+{
+    size_t end = identifier.find_last_not_of("0123456789");
+    if (end != string::npos && end + 1 < identifier.length() && identifier[end] == '_')
+    { // u120_07 is in u120.
+        return identifier.substr(0, end);
+    }
+    if (end != string::npos)
+    { // HARD7 is in HARD.
+        return identifier.substr(0, end + 1);
+    }
+    return identifier;
+}
+
+/**
+ * This function is used to draw random settings of the search around the default ones. The cracks are never tighter
+ * than the default ones, as a tighter crack can make relaxed mbs take much longer than the time of a run.
+ *
+ * @param rng           mt19937 reference type, the random numbers.
+ * @return              SearchConfig type, the settings.
+ */
+SearchConfig random_config(mt19937 &rng)
+{
+    SearchConfig config;
+    config.crack_120 = uniform_int_distribution<int>(3, 20)(rng);
+    config.crack_500 = uniform_int_distribution<int>(5, 30)(rng);
+    config.crack_other = (int)exp(uniform_real_distribution<double>(log(11000), log(110000))(rng));
+    config.neighborhood = uniform_int_distribution<int>(1, 4)(rng);
+    config.shake_timeout = exp(uniform_real_distribution<double>(log(0.001), log(1))(rng));
+    config.split_ratio = uniform_real_distribution<double>(0.25, 0.75)(rng);
+    return config;
+}
+
+/**
+ * This function is used to get the quantile of the chi-squared distribution by the Wilson-Hilferty approximation.
+ *
+ * @param z             double type, the quantile of the normal distribution of the same probability.
+ * @param k             int type, the degrees of freedom.
+ * @return              double type, the quantile.
+ */
+double chi_squared_quantile(double z, int k)
+{
+    double a = 2.0 / (9 * k);
+    return k * pow(1 - a + z * sqrt(a), 3);
+}
+
+/**
+ * This function is used to get the quantile of the Student t distribution by the Cornish-Fisher expansion.
+ *
+ * @param z             double type, the quantile of the normal distribution of the same probability.
+ * @param v             int type, the degrees of freedom.
+ * @return              double type, the quantile.
+ */
+double t_quantile(double z, int v)
+{
+    double z3 = z * z * z;
+    double z5 = z3 * z * z;
+    double z7 = z5 * z * z;
+    return z + (z3 + z) / (4.0 * v) + (5 * z5 + 16 * z3 + 3 * z) / (96.0 * v * v) + (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384.0 * v * v * v);
+}
+
+/**
+ * This function is used to rank the settings still in the race on every instance run so far, the fewest bins first and
+ * the average rank on a tie.
+ *
+ * @param bins          vector<vector<int>> reference type, the bins of every setting on every instance run.
+ * @param alive         vector<int> reference type, the settings still in the race.
+ * @return              vector<vector<double>> type, the rank of every setting still in the race on every instance run.
+ */
+vector<vector<double>> rank_runs(vector<vector<int>> &bins, vector<int> &alive)
+{
+    vector<vector<double>> ranks(bins.size(), vector<double>(alive.size()));
+    for (int b = 0; b < bins.size(); b++)
+    {
+        for (int j = 0; j < alive.size(); j++)
+        {
+            int fewer = 0;
+            int same = 0;
+            for (int k = 0; k < alive.size(); k++)
+            {
+                fewer += bins[b][alive[k]] < bins[b][alive[j]];
+                same += bins[b][alive[k]] == bins[b][alive[j]];
+            }
+            ranks[b][j] = fewer + (same + 1) / 2.0;
+        }
+    }
+    return ranks;
+}
+
+/**
+ * This function is used to drop the settings that are significantly worse than the best one, by the Friedman test at the
+ * level 0.05 and its post-hoc test on the rank sums, as in F-race.
+ *
+ * @param bins          vector<vector<int>> reference type, the bins of every setting on every instance run.
+ * @param alive         vector<int> reference type, the settings still in the race, the dropped ones are taken out.
+ */
+void friedman_race(vector<vector<int>> &bins, vector<int> &alive)
+{
+    vector<vector<double>> ranks = rank_runs(bins, alive);
+    int b = ranks.size();
+    int m = alive.size();
+    vector<double> sums(m, 0);
+    double squares = 0;
+    for (int i = 0; i < b; i++)
+    {
+        for (int j = 0; j < m; j++)
+        {
+            sums[j] += ranks[i][j];
+            squares += ranks[i][j] * ranks[i][j];
+        }
+    }
+    double ties = squares - b * m * (m + 1) * (m + 1) / 4.0;
+    if (ties <= 1e-9)
+    { // Every setting has the same number of bins on every instance.
+        return;
+    }
+    double spread = 0;
+    for (int j = 0; j < m; j++)
+    {
+        spread += (sums[j] - b * (m + 1) / 2.0) * (sums[j] - b * (m + 1) / 2.0);
+    }
+    double statistic = (m - 1) * spread / ties;
+    if (statistic <= chi_squared_quantile(1.644854, m - 1))
+    { // No setting is significantly different yet.
+        return;
+    }
+    int best = min_element(sums.begin(), sums.end()) - sums.begin();
+    double deviation = sqrt(2 * b * (1 - statistic / (b * (m - 1.0))) * ties / ((b - 1.0) * (m - 1.0)));
+    double critical = t_quantile(1.959964, (b - 1) * (m - 1));
+    vector<int> kept;
+    for (int j = 0; j < m; j++)
+    {
+        if (deviation <= 0 || (sums[j] - sums[best]) / deviation <= critical)
+        {
+            kept.push_back(alive[j]);
+        }
+    }
+    alive = kept;
+}
+
+/**
+ * This function is used to solve an instance with every setting still in the race at the same time on the workers.
+ *
+ * @param problem       Problem reference type, the instance.
+ * @param candidates    vector<SearchConfig> reference type, all the settings.
+ * @param alive         vector<int> reference type, the settings still in the race.
+ * @param max_time      int type, the time of a run in seconds.
+ * @param seed          unsigned type, the seed of every run.
+ * @param workers       int type, the number of runs at the same time.
+ * @return              vector<int> type, the bins of every setting, 0 for the settings out of the race.
+ */
+vector<int> run_block(Problem &problem, vector<SearchConfig> &candidates, vector<int> &alive, int max_time, unsigned seed, int workers)
+{
+    vector<int> bins(candidates.size(), 0);
+    atomic<int> next(0);
+    vector<thread> threads;
+    for (int w = 0; w < min(workers, (int)alive.size()); w++)
+    {
+        threads.push_back(thread([&]
+                                 {
+            int j;
+            while ((j = next++) < alive.size())
+            {
+                SolverOptions options;
+                options.max_time = max_time;
+                options.seed = seed;
+                options.config = candidates[alive[j]];
+                bins[alive[j]] = solve_instance(problem, options, nullptr, nullptr).get_objective();
+            } }));
+    }
+    for (int w = 0; w < threads.size(); w++)
+    {
+        threads[w].join();
+    }
+    return bins;
+}
+
+int main(int argc, const char *argv[])
+{
+    vector<string> data_files;
+    int max_time = 1;
+    int num_candidates = 16;
+    int budget = 0;
+    int workers = max(1u, thread::hardware_concurrency());
+    unsigned seed = time(NULL);
+    string output;
+    for (int i = 1; i + 1 < argc; i = i + 2)
+    { // Get the arguments.
+        if (strcmp(argv[i], "-s") == 0)
+        {
+            data_files.push_back(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "-t") == 0)
+        {
+            max_time = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--candidates") == 0)
+        {
+            num_candidates = max(2, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--budget") == 0)
+        {
+            budget = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--workers") == 0)
+        {
+            workers = max(1, atoi(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            seed = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--output") == 0)
+        {
+            output = argv[i + 1];
+        }
+    }
+    if (budget <= 0)
+    {
+        budget = 40 * num_candidates;
+    }
+
+    map<string, vector<Problem>> classes;
+    for (int f = 0; f < data_files.size(); f++)
+    {
+        if (InstanceFile::is_binary(data_files[f]))
+        {
+            InstanceFile binaryFile(data_files[f]);
+            if (!binaryFile.is_open())
+            {
+                cout << "Error opening source file " << data_files[f] << endl;
+                return -1;
+            }
+            for (int i = 0; i < binaryFile.get_num_instances(); i++)
+            {
+                if (!binaryFile.check_problem(i))
+                {
+                    cout << "Error instance " << i << " of " << data_files[f] << " is damaged" << endl;
+                    return -1;
+                }
+                Problem problem = binaryFile.get_problem(i);
+                classes[instance_class(problem.get_identifier())].push_back(problem);
+            }
+            continue;
+        }
+        ifstream inFile(data_files[f].c_str(), ios::in);
+        if (!inFile)
+        {
+            cout << "Error opening source file " << data_files[f] << endl;
+            return -1;
+        }
+        string str;
+        getline(inFile, str);
+        int problem_num = atoi(str.c_str());
+        for (int i = 0; i < problem_num; i++)
+        {
+            Problem problem(inFile);
+            classes[instance_class(problem.get_identifier())].push_back(problem);
+        }
+    }
+    if (classes.empty())
+    {
+        cout << "Error no instance to tune on" << endl;
+        return -1;
+    }
+
+    mt19937 rng(seed);
+    for (map<string, vector<Problem>>::iterator it = classes.begin(); it != classes.end(); it++)
+    {
+        vector<Problem> &instances = it->second;
+        vector<SearchConfig> candidates(1); // The default settings race as well.
+        while (candidates.size() < num_candidates)
+        {
+            candidates.push_back(random_config(rng));
+        }
+        vector<int> alive(candidates.size());
+        for (int j = 0; j < alive.size(); j++)
+        {
+            alive[j] = j;
+        }
+        vector<int> order(instances.size());
+        for (int i = 0; i < order.size(); i++)
+        {
+            order[i] = i;
+        }
+        shuffle(order.begin(), order.end(), rng);
+        vector<vector<int>> bins;
+        int runs = 0;
+        while (alive.size() > 1 && runs + alive.size() <= budget)
+        { // The instances are run again with other seeds when they are all done.
+            Problem &problem = instances[order[bins.size() % order.size()]];
+            bins.push_back(run_block(problem, candidates, alive, max_time, seed + bins.size(), workers));
+            runs += alive.size();
+            if (bins.size() >= FIRST_TEST)
+            {
+                friedman_race(bins, alive);
+            }
+        }
+        vector<vector<double>> ranks = rank_runs(bins, alive);
+        int best = 0;
+        vector<double> sums(alive.size(), 0);
+        for (int b = 0; b < ranks.size(); b++)
+        {
+            for (int j = 0; j < alive.size(); j++)
+            {
+                sums[j] += ranks[b][j];
+            }
+        }
+        for (int j = 1; j < alive.size(); j++)
+        {
+            best = sums[j] < sums[best] ? j : best;
+        }
+        cout << it->first << ": " << instances.size() << " instances, " << runs << " runs, " << alive.size() << " of " << candidates.size() << " settings left" << (alive[best] == 0 ? ", the default wins" : "") << endl;
+        cout << "    ";
+        write_config(cout, candidates[alive[best]]);
+        if (!output.empty())
+        {
+            ofstream configFile((output + "/" + it->first + ".cfg").c_str(), ios::out);
+            write_config(configFile, candidates[alive[best]]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,291 @@
+/**
+ * @File verify.cpp
+ * @Brief A tool to check the solution files of the solver against their data files in O(n) per instance: every item
+ * index appears exactly once, the load of every bin recomputed from the item sizes fits the capacity, and the objective
+ * written is the number of bins.
+ *
+ * Build and run from the repository root:
+ *     g++ -O2 -pthread tools/verify.cpp -o verify && ./verify -s <data file> -o <solution file>
+ * The data file may be a text or a binary instance file. The exit status is 0 only if every instance is feasible, the
+ * solution file holds as many instances as its first line says and at least one of them is checked.
+ * With --bin-types, as given to the solver, every bin must fit the capacity of the type on the "types=" line, no type may
+ * be used more than its limit and the objective written is the total cost. With --max-items and --conflicts, every bin
+ * must keep the side constraints as well.
+ */
+
+#define BPP_NO_MAIN
+#include "../20217275.cpp"
+
+/**
+ * This function is used to read the objective written on the "obj=" line of every instance of a solution file.
+ *
+ * @param inFile        istream reference type, the solution file.
+ * @return              map<string, int> type, the objective by the instance identifier.
+ */
+map<string, int> read_objectives(istream &inFile)
+{
+    map<string, int> objectives;
+    string previous;
+    string str;
+    while (getline(inFile, str))
+    {
+        if (str.compare(0, 4, "obj=") == 0)
+        {
+            objectives[previous] = atoi(str.c_str() + 4);
+        }
+        previous = str;
+    }
+    return objectives;
+}
+
+/**
+ * This function is used to read the bin type of every bin written on the "types=" line of every instance.
+ *
+ * @param inFile        istream reference type, the solution file.
+ * @return              map<string, vector<int>> type, the bin types by the instance identifier.
+ */
+map<string, vector<int>> read_types(istream &inFile)
+{
+    map<string, vector<int>> types;
+    string identifier;
+    string previous;
+    string str;
+    while (getline(inFile, str))
+    {
+        if (str.compare(0, 4, "obj=") == 0)
+        {
+            identifier = previous;
+        }
+        else if (str.compare(0, 6, "types=") == 0)
+        {
+            istringstream line(str.substr(6));
+            int type;
+            while (line >> type)
+            {
+                types[identifier].push_back(type);
+            }
+        }
+        previous = str;
+    }
+    return types;
+}
+
+/**
+ * This function is used to check the bin types of a packing: one type per bin, the load of every bin within the capacity
+ * of its type and the limit of every type.
+ *
+ * @param size_of       vector<int> reference type, the size of every item index.
+ * @param bin_types     vector<BinType> reference type, the bin types.
+ * @param packing       vector<vector<int>> reference type, the item indexes of every bin, checked already.
+ * @param types         vector<int> reference type, the bin type of every non-empty bin.
+ * @param cost          long long reference type, set to the total cost.
+ * @return              string type, the first problem found, empty if there is none.
+ */
+string check_types(vector<int> &size_of, vector<BinType> &bin_types, vector<vector<int>> &packing, vector<int> &types, long long &cost)
+{
+    vector<int> used(bin_types.size(), 0);
+    int bin = 0;
+    cost = 0;
+    for (int i = 0; i < packing.size(); i++)
+    {
+        if (packing[i].empty())
+        {
+            continue;
+        }
+        if (bin >= types.size() || types[bin] < 0 || types[bin] >= bin_types.size())
+        {
+            return "bin " + to_string(i) + " has no valid type";
+        }
+        BinType &type = bin_types[types[bin++]];
+        long long load = 0;
+        for (int k = 0; k < packing[i].size(); k++)
+        {
+            load += size_of[packing[i][k]];
+        }
+        if (load > type.capacity)
+        {
+            return "bin " + to_string(i) + " holds " + to_string(load) + " over the capacity " + to_string(type.capacity) + " of its type";
+        }
+        cost += type.cost;
+        used[types[bin - 1]]++;
+    }
+    if (bin != types.size())
+    {
+        return "there are " + to_string(types.size()) + " types for " + to_string(bin) + " bins";
+    }
+    for (int t = 0; t < bin_types.size(); t++)
+    {
+        if (bin_types[t].limit != 0 && used[t] > bin_types[t].limit)
+        {
+            return to_string(used[t]) + " bins of type " + to_string(t) + " over its limit " + to_string(bin_types[t].limit);
+        }
+    }
+    return "";
+}
+
+int main(int argc, const char *argv[])
+{
+    string data_file;
+    string solution_file;
+    vector<BinType> bin_types;
+    int max_items = 0;
+    map<string, vector<pair<int, int>>> conflicts;
+    for (int i = 1; i + 1 < argc; i = i + 2)
+    { // Get the arguments.
+        if (strcmp(argv[i], "-s") == 0)
+        {
+            data_file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "-o") == 0)
+        {
+            solution_file = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "--bin-types") == 0 && !parse_bin_types(argv[i + 1], bin_types))
+        {
+            cout << "Error reading bin types" << endl;
+            return 2;
+        }
+        else if (strcmp(argv[i], "--max-items") == 0)
+        {
+            max_items = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--conflicts") == 0)
+        {
+            ifstream conflictFile(argv[i + 1], ios::in);
+            if (!conflictFile)
+            {
+                cout << "Error opening conflict file" << endl;
+                return 2;
+            }
+            conflicts = read_conflicts(conflictFile);
+        }
+    }
+    ifstream solutionFile(solution_file.c_str(), ios::in);
+    if (!solutionFile)
+    {
+        cout << "Error opening solution file" << endl;
+        return 2;
+    }
+    string header;
+    getline(solutionFile, header);
+    int num_written = atoi(header.c_str()); // The first line is the number of instances in the file.
+    solutionFile.clear();
+    solutionFile.seekg(0);
+    map<string, vector<vector<int>>> packings = read_solutions(solutionFile);
+    solutionFile.clear();
+    solutionFile.seekg(0);
+    map<string, int> objectives = read_objectives(solutionFile);
+    solutionFile.clear();
+    solutionFile.seekg(0);
+    map<string, vector<int>> types = read_types(solutionFile);
+
+    vector<Problem> problems;
+    if (InstanceFile::is_binary(data_file))
+    {
+        InstanceFile binaryFile(data_file);
+        if (!binaryFile.is_open())
+        {
+            cout << "Error opening source file" << endl;
+            return 2;
+        }
+        for (int i = 0; i < binaryFile.get_num_instances(); i++)
+        {
+            if (!binaryFile.check_problem(i))
+            {
+                cout << "Error instance " << i << " of the binary file is damaged" << endl;
+                return 2;
+            }
+            problems.push_back(binaryFile.get_problem(i));
+        }
+    }
+    else
+    {
+        ifstream inFile(data_file.c_str(), ios::in);
+        if (!inFile)
+        {
+            cout << "Error opening source file" << endl;
+            return 2;
+        }
+        string str;
+        getline(inFile, str);
+        int problem_num = atoi(str.c_str());
+        for (int i = 0; i < problem_num; i++)
+        {
+            problems.push_back(Problem(inFile));
+        }
+    }
+
+    int num_failed = 0;
+    int num_checked = 0;
+    for (int i = 0; i < problems.size(); i++)
+    {
+        map<string, vector<vector<int>>>::iterator packing = packings.find(problems[i].get_identifier());
+        if (packing == packings.end())
+        { // A solution file may hold only some of the instances.
+            continue;
+        }
+        num_checked++;
+        vector<int> size_of = item_sizes(problems[i]);
+        if (!bin_types.empty())
+        { // The largest type bounds every bin, the types are checked below.
+            fit_bin_types(problems[i], bin_types);
+        }
+        string error = check_packing(size_of, problems[i].get_capacity(), packing->second);
+        int num_bins = 0;
+        for (int k = 0; k < packing->second.size(); k++)
+        {
+            num_bins += !packing->second[k].empty();
+        }
+        if (error.empty() && (max_items > 0 || !conflicts[packing->first].empty()))
+        {
+            Constraints constraints(max_items, conflicts[packing->first]);
+            for (int k = 0; k < packing->second.size() && error.empty(); k++)
+            {
+                error = constraints.check(packing->second[k]);
+                if (!error.empty())
+                {
+                    error = "bin " + to_string(k) + " has " + error;
+                }
+            }
+        }
+        long long cost = num_bins;
+        if (error.empty() && !bin_types.empty())
+        {
+            error = check_types(size_of, bin_types, packing->second, types[packing->first], cost);
+        }
+        if (error.empty() && objectives[packing->first] != cost)
+        {
+            error = "obj= says " + to_string(objectives[packing->first]) + " but the " + (bin_types.empty() ? "bins are " : "bins cost ") + to_string(cost);
+        }
+        if (error.empty())
+        {
+            cout << packing->first << ": OK, " << num_bins << " bins";
+            if (!bin_types.empty())
+            {
+                cout << " of cost " << cost;
+            }
+            cout << endl;
+        }
+        else
+        {
+            cout << packing->first << ": INFEASIBLE, " << error << endl;
+            num_failed++;
+        }
+    }
+    if (num_checked != packings.size())
+    {
+        cout << packings.size() - num_checked << " solved instances are not in the data file" << endl;
+        num_failed++;
+    }
+    if (packings.size() != num_written)
+    { // An empty or truncated solution file.
+        cout << "the solution file holds " << packings.size() << " instances instead of " << num_written << endl;
+        num_failed++;
+    }
+    if (num_checked == 0)
+    {
+        cout << "no instance was checked" << endl;
+        num_failed++;
+    }
+    return num_failed == 0 ? 0 : 1;
+}